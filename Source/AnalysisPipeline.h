@@ -0,0 +1,273 @@
+#pragma once
+
+#include <concepts>
+#include <cstddef>
+#include <tuple>
+#include "SpectrumSnapshot.h"
+
+//==============================================================================
+// Sample rate and sizes the stages are prepared for
+struct AnalysisContext
+{
+    double sampleRate = 44100.0;
+    int fftSize = SpectrumSnapshot::fftSize;
+    int numBins = SpectrumSnapshot::numBins;
+};
+
+// One frame as it travels through the stages
+struct AnalysisFrame
+{
+    // Windowed time frames; right == left for mono input
+    const float* left = nullptr;
+    const float* right = nullptr;
+    bool isStereo = false;
+    int numSamples = 0;
+
+    // Spectrum worked on in place. Holds numBins + 1 values so a transform can
+    // write DC to Nyquist; the stages after it only look at numBins.
+    float* bins = nullptr;
+    int numBins = 0;
+
+    // Per-frame results that are published alongside the spectrum
+    SpectrumSnapshot* snapshot = nullptr;
+};
+
+//==============================================================================
+// A bin stage maps one bin value to the next and may keep per-bin state
+template <typename Stage>
+concept AnalysisBinStage = requires (Stage& stage, int bin, float value)
+{
+    { stage.processBin(bin, value) } -> std::convertible_to<float>;
+};
+
+// A frame stage needs the whole frame at once (transforms, smoothing across bins)
+template <typename Stage>
+concept AnalysisFrameStage = requires (Stage& stage, AnalysisFrame& frame)
+{
+    stage.processFrame(frame);
+};
+
+//==============================================================================
+// Analysis chain composed at compile time. Consecutive bin stages are fused
+// into one loop over the bins, so each value goes through the whole run while
+// it is in a register; frame stages split the chain into separate passes.
+// Adding a bin stage to a run therefore adds no memory pass.
+//
+// Optional stage hooks, called when present:
+//   void prepare(const AnalysisContext&)  - allocate; not real-time safe
+//   void configure(const Settings&)       - runtime settings, no allocation
+//   void beginFrame(const AnalysisFrame&) - before the pass the stage runs in
+//   static constexpr int numPasses        - passes a frame stage makes over
+//                                           the bins at most (default 1)
+//   bool isActive() const                 - frame stage that can switch off:
+//                                           while false it is skipped and the
+//                                           bin runs either side of it fuse
+template <typename... Stages>
+class AnalysisPipeline
+{
+public:
+    //==============================================================================
+    static constexpr size_t numStages = sizeof...(Stages);
+
+    static_assert(((AnalysisBinStage<Stages> != AnalysisFrameStage<Stages>) && ...),
+                  "Every stage needs exactly one of processBin() or processFrame()");
+
+    //==============================================================================
+    void prepare(const AnalysisContext& context)
+    {
+        std::apply([&context](auto&... stage) { (callPrepare(stage, context), ...); }, stages);
+    }
+
+    template <typename Settings>
+    void configure(const Settings& settings) noexcept
+    {
+        std::apply([&settings](auto&... stage) { (callConfigure(stage, settings), ...); }, stages);
+    }
+
+    void process(AnalysisFrame& frame) noexcept
+    {
+        runFrom<0>(frame);
+    }
+
+    //==============================================================================
+    template <typename Stage>
+    Stage& get() noexcept { return std::get<Stage>(stages); }
+
+    template <typename Stage>
+    const Stage& get() const noexcept { return std::get<Stage>(stages); }
+
+    // Memory passes over the spectrum per frame: one per fused run of bin
+    // stages plus what each frame stage declares. getNumPasses() is the usual
+    // case with every optional frame stage off, getMaxNumPasses() has them on.
+    static constexpr int getNumPasses() noexcept { return countPasses<0, false>(); }
+    static constexpr int getMaxNumPasses() noexcept { return countPasses<0, true>(); }
+
+private:
+    //==============================================================================
+    using StageTuple = std::tuple<Stages...>;
+
+    template <size_t Index>
+    static constexpr bool isBinStage = AnalysisBinStage<std::tuple_element_t<Index, StageTuple>>;
+
+    template <size_t Index>
+    static constexpr bool isOptionalStage = !isBinStage<Index>
+        && requires (const std::tuple_element_t<Index, StageTuple>& stage) { { stage.isActive() } -> std::convertible_to<bool>; };
+
+    // True if Index is an optional frame stage with a bin stage after it
+    template <size_t Index>
+    static constexpr bool canFuseAcross() noexcept
+    {
+        if constexpr (Index + 1 >= numStages)
+            return false;
+        else
+            return isOptionalStage<Index> && isBinStage<Index + 1>;
+    }
+
+    // One past the last bin stage of the run starting at Index
+    template <size_t Index>
+    static constexpr size_t endOfBinRun() noexcept
+    {
+        if constexpr (Index >= numStages)
+            return Index;
+        else if constexpr (isBinStage<Index>)
+            return endOfBinRun<Index + 1>();
+        else
+            return Index;
+    }
+
+    template <size_t Index, bool withOptionalStages>
+    static constexpr int countPasses() noexcept
+    {
+        if constexpr (Index >= numStages)
+        {
+            return 0;
+        }
+        else if constexpr (isBinStage<Index>)
+        {
+            constexpr size_t end = endOfBinRun<Index>();
+
+            if constexpr (!withOptionalStages && canFuseAcross<end>())
+                return 1 + countPasses<endOfBinRun<end + 1>(), withOptionalStages>();
+            else
+                return 1 + countPasses<end, withOptionalStages>();
+        }
+        else if constexpr (!withOptionalStages && isOptionalStage<Index>)
+        {
+            return countPasses<Index + 1, withOptionalStages>();
+        }
+        else
+        {
+            return framePasses<std::tuple_element_t<Index, StageTuple>>() + countPasses<Index + 1, withOptionalStages>();
+        }
+    }
+
+    template <typename Stage>
+    static constexpr int framePasses() noexcept
+    {
+        if constexpr (requires { Stage::numPasses; })
+            return Stage::numPasses;
+        else
+            return 1;
+    }
+
+    //==============================================================================
+    template <size_t Index>
+    void runFrom(AnalysisFrame& frame) noexcept
+    {
+        if constexpr (Index < numStages)
+        {
+            if constexpr (isBinStage<Index>)
+            {
+                constexpr size_t end = endOfBinRun<Index>();
+
+                if constexpr (canFuseAcross<end>())
+                {
+                    // The frame stage after this run is off: carry on through the next run
+                    if (!std::get<end>(stages).isActive())
+                    {
+                        constexpr size_t next = endOfBinRun<end + 1>();
+                        runBins<Index, end, end + 1, next>(frame);
+                        runFrom<next>(frame);
+                        return;
+                    }
+                }
+
+                runBins<Index, end, end, end>(frame);
+                runFrom<end>(frame);
+            }
+            else
+            {
+                auto& stage = std::get<Index>(stages);
+
+                if constexpr (isOptionalStage<Index>)
+                {
+                    if (!stage.isActive())
+                    {
+                        runFrom<Index + 1>(frame);
+                        return;
+                    }
+                }
+
+                if constexpr (requires { stage.beginFrame(frame); })
+                    stage.beginFrame(frame);
+
+                stage.processFrame(frame);
+                runFrom<Index + 1>(frame);
+            }
+        }
+    }
+
+    // One loop over the bins through the stages [First, FirstEnd), then [Second, SecondEnd)
+    template <size_t First, size_t FirstEnd, size_t Second, size_t SecondEnd>
+    void runBins(AnalysisFrame& frame) noexcept
+    {
+        beginRun<First, FirstEnd>(frame);
+        beginRun<Second, SecondEnd>(frame);
+
+        float* bins = frame.bins;
+        const int numBins = frame.numBins;
+
+        for (int i = 0; i < numBins; ++i)
+            bins[i] = applyRun<Second, SecondEnd>(i, applyRun<First, FirstEnd>(i, bins[i]));
+    }
+
+    template <size_t Index, size_t End>
+    void beginRun(const AnalysisFrame& frame) noexcept
+    {
+        if constexpr (Index < End)
+        {
+            auto& stage = std::get<Index>(stages);
+
+            if constexpr (requires { stage.beginFrame(frame); })
+                stage.beginFrame(frame);
+
+            beginRun<Index + 1, End>(frame);
+        }
+    }
+
+    template <size_t Index, size_t End>
+    float applyRun(int bin, float value) noexcept
+    {
+        if constexpr (Index == End)
+            return value;
+        else
+            return applyRun<Index + 1, End>(bin, std::get<Index>(stages).processBin(bin, value));
+    }
+
+    //==============================================================================
+    template <typename Stage>
+    static void callPrepare(Stage& stage, const AnalysisContext& context)
+    {
+        if constexpr (requires { stage.prepare(context); })
+            stage.prepare(context);
+    }
+
+    template <typename Stage, typename Settings>
+    static void callConfigure(Stage& stage, const Settings& settings) noexcept
+    {
+        if constexpr (requires { stage.configure(settings); })
+            stage.configure(settings);
+    }
+
+    StageTuple stages;
+};
@@ -0,0 +1,61 @@
+#include "AnalysisScheduler.h"
+
+//==============================================================================
+AnalysisScheduler::~AnalysisScheduler()
+{
+    stopTimer();
+}
+
+void AnalysisScheduler::addClient(Client* client)
+{
+    clients.addIfNotAlreadyThere(client);
+    updateRate();
+}
+
+void AnalysisScheduler::removeClient(Client* client)
+{
+    clients.removeFirstMatchingValue(client);
+    updateRate();
+}
+
+//==============================================================================
+void AnalysisScheduler::timerCallback()
+{
+    const double now = juce::Time::getMillisecondCounterHiRes() * 0.001;
+    const double elapsed = now - lastTickSeconds;
+    lastTickSeconds = now;
+
+    // Backwards, so a client may remove itself from its tick
+    for (int i = clients.size(); --i >= 0;)
+        if (i < clients.size())
+            clients.getUnchecked(i)->analysisTick(elapsed);
+
+    updateRate();
+}
+
+void AnalysisScheduler::updateRate()
+{
+    int rateHz = clients.isEmpty() ? 0 : idleRateHz;
+
+    for (auto* client : clients)
+    {
+        if (client->wantsFastTicks())
+        {
+            rateHz = fastRateHz;
+            break;
+        }
+    }
+
+    if (rateHz == currentRateHz)
+        return;
+
+    if (currentRateHz == 0)
+        lastTickSeconds = juce::Time::getMillisecondCounterHiRes() * 0.001;
+
+    currentRateHz = rateHz;
+
+    if (rateHz == 0)
+        stopTimer();
+    else
+        startTimerHz(rateHz);
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <juce_events/juce_events.h>
+
+//==============================================================================
+// One message-thread timer shared by every plugin instance in the process
+// (hold it through juce::SharedResourcePointer), so a session full of
+// analysers polls once per tick rather than once per instance. It ticks at
+// idleRateHz, at fastRateHz only while some client expects a frame within a
+// tick, and not at all without clients.
+class AnalysisScheduler : private juce::Timer
+{
+public:
+    //==============================================================================
+    static constexpr int idleRateHz = 60;
+    static constexpr int fastRateHz = 240;
+
+    class Client
+    {
+    public:
+        virtual ~Client() = default;
+
+        // Message thread; elapsedSeconds since the previous tick
+        virtual void analysisTick(double elapsedSeconds) = 0;
+
+        // True while frames arrive faster than idleRateHz would pick them up
+        virtual bool wantsFastTicks() const = 0;
+    };
+
+    //==============================================================================
+    AnalysisScheduler() = default;
+    ~AnalysisScheduler() override;
+
+    // Message thread only
+    void addClient(Client* client);
+    void removeClient(Client* client);
+
+    int getCurrentRateHz() const noexcept { return currentRateHz; }
+
+private:
+    //==============================================================================
+    void timerCallback() override;
+    void updateRate();
+
+    juce::Array<Client*> clients;
+    double lastTickSeconds = 0.0;
+    int currentRateHz = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(AnalysisScheduler)
+};
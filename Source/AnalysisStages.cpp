@@ -0,0 +1,176 @@
+#include "AnalysisStages.h"
+#include <algorithm>
+
+namespace AnalysisStages
+{
+    //==============================================================================
+    Transform::Transform()
+        : fft(SpectrumSnapshot::fftOrder),
+          leftSpectrum(static_cast<size_t>(fft.getNumBins())),
+          rightSpectrum(static_cast<size_t>(fft.getNumBins())),
+          mixFrame(static_cast<size_t>(fft.getSize()))
+    {
+    }
+
+    void Transform::configure(const AnalysisSettings& settings) noexcept
+    {
+        // Averages from an earlier stereo session would be stale
+        if (settings.stereoAnalysisEnabled && !stereoEnabled)
+            stereoAnalyzer.reset();
+
+        stereoEnabled = settings.stereoAnalysisEnabled;
+    }
+
+    void Transform::processFrame(AnalysisFrame& frame) noexcept
+    {
+        jassert(frame.numSamples == fft.getSize());
+
+        if (stereoEnabled && frame.snapshot != nullptr)
+        {
+            // Transform each channel once; the mid magnitude and all stereo
+            // measurements are derived from these two spectra
+            fft.performForward(frame.left, leftSpectrum.data());
+
+            if (frame.isStereo)
+                fft.performForward(frame.right, rightSpectrum.data());
+
+            stereoAnalyzer.process(leftSpectrum.data(),
+                                   frame.isStereo ? rightSpectrum.data() : leftSpectrum.data(),
+                                   frame.bins, *frame.snapshot);
+        }
+        else if (frame.isStereo)
+        {
+            // Magnitude only: one transform of the mono mix
+            for (int i = 0; i < frame.numSamples; ++i)
+                mixFrame[static_cast<size_t>(i)] = 0.5f * (frame.left[i] + frame.right[i]);
+
+            fft.performMagnitudes(mixFrame.data(), frame.bins);
+        }
+        else
+        {
+            fft.performMagnitudes(frame.left, frame.bins);
+        }
+    }
+
+    //==============================================================================
+    void OctaveSmoothing::prepare(const AnalysisContext& context)
+    {
+        const auto numBins = static_cast<size_t>(context.numBins);
+
+        bandStart.resize(numBins);
+        bandEnd.resize(numBins);
+        prefix.resize(numBins + 1);
+
+        updateBands();
+    }
+
+    void OctaveSmoothing::configure(const AnalysisSettings& settings) noexcept
+    {
+        const int newFraction = juce::jmax(0, settings.octaveFraction);
+
+        if (newFraction != fraction)
+        {
+            fraction = newFraction;
+            updateBands();
+        }
+    }
+
+    void OctaveSmoothing::updateBands() noexcept
+    {
+        if (fraction == 0)
+            return;
+
+        const int numBins = static_cast<int>(bandStart.size());
+        const double halfBandRatio = std::pow(2.0, 0.5 / fraction);
+
+        for (int k = 0; k < numBins; ++k)
+        {
+            const int start = juce::jlimit(0, numBins - 1, static_cast<int>(std::floor(k / halfBandRatio)));
+            const int end = juce::jlimit(start + 1, numBins, static_cast<int>(std::ceil(k * halfBandRatio)) + 1);
+
+            bandStart[static_cast<size_t>(k)] = start;
+            bandEnd[static_cast<size_t>(k)] = end;
+        }
+    }
+
+    void OctaveSmoothing::processFrame(AnalysisFrame& frame) noexcept
+    {
+        if (fraction == 0)
+            return;
+
+        const int numBins = juce::jmin(frame.numBins, static_cast<int>(bandStart.size()));
+        float* bins = frame.bins;
+
+        prefix[0] = 0.0;
+
+        for (int i = 0; i < numBins; ++i)
+            prefix[static_cast<size_t>(i + 1)] = prefix[static_cast<size_t>(i)] + std::pow(10.0, 0.1 * bins[i]);
+
+        for (int k = 0; k < numBins; ++k)
+        {
+            const int start = bandStart[static_cast<size_t>(k)];
+            const int end = bandEnd[static_cast<size_t>(k)];
+            const double power = (prefix[static_cast<size_t>(end)] - prefix[static_cast<size_t>(start)]) / (end - start);
+
+            bins[k] = power > 0.0 ? juce::jlimit(mindB, maxdB, static_cast<float>(10.0 * std::log10(power))) : mindB;
+        }
+    }
+
+    //==============================================================================
+    void Weighting::prepare(const AnalysisContext& context)
+    {
+        const auto numBins = static_cast<size_t>(context.numBins);
+        aGains.resize(numBins);
+        cGains.resize(numBins);
+
+        // IEC 61672-1 pole frequencies
+        constexpr double f1 = 20.598997, f2 = 107.65265, f3 = 737.86223, f4 = 12194.217;
+        const double aOffset = std::pow(10.0, 2.0 / 20.0);   // +2.0 dB: A(1 kHz) = 0 dB
+        const double cOffset = std::pow(10.0, 0.062 / 20.0); // +0.062 dB: C(1 kHz) = 0 dB
+
+        for (size_t k = 0; k < numBins; ++k)
+        {
+            const double f = static_cast<double>(k) * context.sampleRate / context.fftSize;
+            const double f2Squared = f * f;
+            const double common = (f2Squared + f1 * f1) * (f2Squared + f4 * f4);
+
+            const double rc = f4 * f4 * f2Squared / common;
+            const double ra = f4 * f4 * f2Squared * f2Squared
+                              / (common * std::sqrt((f2Squared + f2 * f2) * (f2Squared + f3 * f3)));
+
+            aGains[k] = static_cast<float>(ra * aOffset);
+            cGains[k] = static_cast<float>(rc * cOffset);
+        }
+
+        // Re-point at the rebuilt table
+        setWeighting(type);
+    }
+
+    void Weighting::configure(const AnalysisSettings& settings) noexcept
+    {
+        setWeighting(settings.weighting);
+    }
+
+    void Weighting::setWeighting(AnalysisSettings::Weighting newType) noexcept
+    {
+        type = newType;
+
+        switch (type)
+        {
+            case AnalysisSettings::Weighting::a:    gains = aGains.empty() ? nullptr : aGains.data(); break;
+            case AnalysisSettings::Weighting::c:    gains = cGains.empty() ? nullptr : cGains.data(); break;
+            case AnalysisSettings::Weighting::flat: gains = nullptr; break;
+        }
+    }
+
+    //==============================================================================
+    void TimeSmoothing::configure(const AnalysisSettings& settings) noexcept
+    {
+        amount = juce::jlimit(0.0f, 0.99f, settings.timeSmoothing);
+    }
+
+    void PeakHold::configure(const AnalysisSettings& settings) noexcept
+    {
+        enabled = settings.peakHoldEnabled;
+    }
+}
@@ -0,0 +1,192 @@
+#pragma once
+
+#include <juce_dsp/juce_dsp.h>
+#include <cmath>
+#include <vector>
+#include "AnalysisPipeline.h"
+#include "RealFFT.h"
+#include "StereoAnalyzer.h"
+
+//==============================================================================
+// User-facing analysis settings, applied to the stages through configure()
+struct AnalysisSettings
+{
+    enum class Weighting
+    {
+        flat,
+        a,
+        c
+    };
+
+    Weighting weighting = Weighting::flat;
+    int octaveFraction = 0;           // Smoothing over 1/N octave, 0 = off
+    float timeSmoothing = 0.7f;       // Weight of the previous frame
+    bool peakHoldEnabled = true;
+    float peakDecaydBPerSecond = 18.0f;  // Peak hold fall rate
+    bool stereoAnalysisEnabled = false;
+};
+
+//==============================================================================
+// Building blocks for AnalysisPipeline. Stages that keep per-bin state write
+// into storage owned by the caller, so results land where they are published
+// without a copy.
+namespace AnalysisStages
+{
+    // dB range shared by the stages and the display
+    static constexpr float mindB = -100.0f;
+    static constexpr float maxdB = 0.0f;
+
+    //==============================================================================
+    // Real FFT of the windowed frame to linear magnitudes. With stereo analysis
+    // each channel is transformed once and the mid magnitude plus the stereo
+    // measurements come from those spectra; otherwise one transform of the mix.
+    class Transform
+    {
+    public:
+        Transform();
+
+        void configure(const AnalysisSettings& settings) noexcept;
+        void processFrame(AnalysisFrame& frame) noexcept;
+
+    private:
+        RealFFT fft;
+        StereoAnalyzer stereoAnalyzer;
+        std::vector<RealFFT::Complex> leftSpectrum, rightSpectrum;
+        std::vector<float> mixFrame;
+        bool stereoEnabled = false;
+    };
+
+    //==============================================================================
+    // Fractional-octave smoothing of the dB spectrum (power average over a band
+    // of +/- 1/(2N) octave around each bin) using prefix sums: two passes
+    // whatever the bandwidth. When switched off the pipeline skips it and fuses
+    // the bin stages around it. Runs after the raw dB values are tapped, so
+    // only the displayed spectrum is smoothed.
+    class OctaveSmoothing
+    {
+    public:
+        static constexpr int numPasses = 2;  // Prefix sums, then band averages
+
+        void prepare(const AnalysisContext& context);
+        void configure(const AnalysisSettings& settings) noexcept;
+        bool isActive() const noexcept { return fraction > 0; }
+        void processFrame(AnalysisFrame& frame) noexcept;
+
+    private:
+        void updateBands() noexcept;
+
+        int fraction = 0;
+        std::vector<int> bandStart, bandEnd;
+        std::vector<double> prefix;
+    };
+
+    //==============================================================================
+    // Scales FFT magnitudes to full scale
+    class Normalise
+    {
+    public:
+        void prepare(const AnalysisContext& context) noexcept { scale = 1.0f / static_cast<float>(context.fftSize); }
+        float processBin(int, float value) const noexcept { return value * scale; }
+
+    private:
+        float scale = 1.0f / static_cast<float>(SpectrumSnapshot::fftSize);
+    };
+
+    //==============================================================================
+    // IEC 61672 A or C frequency weighting as a per-bin gain table
+    class Weighting
+    {
+    public:
+        void prepare(const AnalysisContext& context);
+        void configure(const AnalysisSettings& settings) noexcept;
+        void setWeighting(AnalysisSettings::Weighting newType) noexcept;
+
+        float processBin(int bin, float value) const noexcept
+        {
+            return gains != nullptr ? value * gains[bin] : value;
+        }
+
+    private:
+        std::vector<float> aGains, cGains;
+        AnalysisSettings::Weighting type = AnalysisSettings::Weighting::flat;
+        const float* gains = nullptr;
+    };
+
+    //==============================================================================
+    // Linear magnitude to dB, clamped to the display range
+    class Decibels
+    {
+    public:
+        float processBin(int, float value) const noexcept
+        {
+            return value > 0.0f ? juce::jlimit(mindB, maxdB, 20.0f * std::log10(value)) : mindB;
+        }
+    };
+
+    //==============================================================================
+    // Copies the value at this point of the chain into caller-owned storage
+    class Tap
+    {
+    public:
+        void setDestination(float* newDestination) noexcept { destination = newDestination; }
+
+        float processBin(int bin, float value) const noexcept
+        {
+            destination[bin] = value;
+            return value;
+        }
+
+    private:
+        float* destination = nullptr;
+    };
+
+    //==============================================================================
+    // Exponential smoothing over time; the state is the smoothed spectrum
+    class TimeSmoothing
+    {
+    public:
+        void setState(float* newState) noexcept { state = newState; }
+        void configure(const AnalysisSettings& settings) noexcept;
+
+        float processBin(int bin, float value) const noexcept
+        {
+            auto& smoothed = state[bin];
+            smoothed = smoothed * amount + value * (1.0f - amount);
+            return smoothed;
+        }
+
+    private:
+        float* state = nullptr;
+        float amount = 0.7f;
+    };
+
+    //==============================================================================
+    // Peak hold; passes the value through unchanged. The decay is by elapsed
+    // time, applied between frames with SpectrumAnalysisEngine::decayPeakHold().
+    class PeakHold
+    {
+    public:
+        void setState(float* newState) noexcept { peaks = newState; }
+        void configure(const AnalysisSettings& settings) noexcept;
+
+        float processBin(int bin, float value) const noexcept
+        {
+            if (!enabled)
+                return value;
+
+            auto& peak = peaks[bin];
+
+            // Only update peak if signal is above noise floor
+            if (value > noiseFloor && value > peak)
+                peak = value;
+
+            return value;
+        }
+
+    private:
+        static constexpr float noiseFloor = -96.0f;  // Threshold below which we ignore
+
+        float* peaks = nullptr;
+        bool enabled = true;
+    };
+}
@@ -0,0 +1,70 @@
+#include "ColumnReducer.h"
+#include <algorithm>
+#include <cmath>
+
+//==============================================================================
+void ColumnReducer::prepare(int numColumns, int newNumBins, double sampleRate, int fftSize,
+                            float minFreq, float maxFreq)
+{
+    numColumns = std::max(0, numColumns);
+    numBins = std::max(0, newNumBins);
+    preparedSampleRate = sampleRate;
+    numValidColumns = 0;
+
+    // resize() within capacity keeps the existing allocation
+    layout.resize(static_cast<size_t>(numColumns));
+
+    if (numColumns == 0 || numBins < 2 || sampleRate <= 0.0 || fftSize <= 0)
+        return;
+
+    const double binWidth = sampleRate / fftSize;
+    const double nyquist = sampleRate * 0.5;
+    const double logRatio = std::log(static_cast<double>(maxFreq) / minFreq);
+
+    // Frequency at the left edge of a (possibly fractional) column position
+    auto frequencyAt = [&](double column)
+    {
+        return minFreq * std::exp(logRatio * column / numColumns);
+    };
+
+    for (int c = 0; c < numColumns; ++c)
+    {
+        const double centre = frequencyAt(c + 0.5);
+
+        if (centre >= nyquist)
+            break;
+
+        auto& column = layout[static_cast<size_t>(c)];
+
+        // Bins whose centre frequency falls inside [left, right); DC is never shown
+        const int first = std::max(1, static_cast<int>(std::ceil(frequencyAt(c) / binWidth)));
+        const int end = std::min(numBins, static_cast<int>(std::ceil(frequencyAt(c + 1) / binWidth)));
+
+        column.firstBin = first;
+        column.endBin = std::max(first, end);
+        column.interpolatedBin = static_cast<float>(std::clamp(centre / binWidth, 1.0, numBins - 1.0));
+
+        numValidColumns = c + 1;
+    }
+}
+
+void ColumnReducer::reduce(const float* bins, float* columns) const noexcept
+{
+    for (int c = 0; c < numValidColumns; ++c)
+    {
+        const auto& column = layout[static_cast<size_t>(c)];
+
+        if (column.endBin > column.firstBin)
+        {
+            columns[c] = *std::max_element(bins + column.firstBin, bins + column.endBin);
+        }
+        else
+        {
+            const int lower = static_cast<int>(column.interpolatedBin);
+            const int upper = std::min(lower + 1, numBins - 1);
+            const float fraction = column.interpolatedBin - static_cast<float>(lower);
+
+            columns[c] = bins[lower] + (bins[upper] - bins[lower]) * fraction;
+        }
+    }
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <vector>
+
+//==============================================================================
+// Maps FFT bins onto the pixel columns of a logarithmic frequency axis. A
+// column that covers several bins takes their maximum (so narrow peaks are
+// never lost); a column between two bins interpolates them. The layout is
+// built once per width and sample rate, after which reducing a spectrum is a
+// single pass over the bins and needs no frequency maths.
+class ColumnReducer
+{
+public:
+    //==============================================================================
+    // Rebuilds the layout; allocates only when numColumns grows
+    void prepare(int numColumns, int numBins, double sampleRate, int fftSize,
+                 float minFreq, float maxFreq);
+
+    bool isPreparedFor(int numColumns, double sampleRate) const noexcept
+    {
+        return numColumns == static_cast<int>(layout.size()) && sampleRate == preparedSampleRate;
+    }
+
+    int getNumColumns() const noexcept { return static_cast<int>(layout.size()); }
+
+    // Columns whose frequency lies below Nyquist; the rest are left untouched
+    int getNumValidColumns() const noexcept { return numValidColumns; }
+
+    // Horizontal centre of a column in pixels
+    static float getColumnX(int column) noexcept { return static_cast<float>(column) + 0.5f; }
+
+    // bins: numBins values, columns: getNumColumns() values
+    void reduce(const float* bins, float* columns) const noexcept;
+
+private:
+    //==============================================================================
+    struct Column
+    {
+        int firstBin = 0;          // Aggregate [firstBin, endBin) when non-empty
+        int endBin = 0;
+        float interpolatedBin = 0; // Fractional bin used when the range is empty
+    };
+
+    std::vector<Column> layout;
+    int numBins = 0;
+    int numValidColumns = 0;
+    double preparedSampleRate = 0.0;
+};
@@ -0,0 +1,172 @@
+#include "HalfbandDecimator.h"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    // Zeroth-order modified Bessel function of the first kind
+    double besselI0(double x) noexcept
+    {
+        double sum = 1.0;
+        double term = 1.0;
+
+        for (int k = 1; k < 50 && term > 1.0e-12 * sum; ++k)
+        {
+            const double half = x / (2.0 * k);
+            term *= half * half;
+            sum += term;
+        }
+
+        return sum;
+    }
+}
+
+//==============================================================================
+void HalfbandDecimator::prepare(double inputRate, double passbandHz, double attenuationDb)
+{
+    // Halfband transition is symmetric about inputRate / 4: from the passband
+    // edge up to the frequency that folds back onto it
+    const double passband = std::min(passbandHz, inputRate * 0.24);
+    const double transition = std::max(0.01, (inputRate * 0.5 - 2.0 * passband) / inputRate);
+
+    // Kaiser estimate of the length, rounded up to the 4K - 1 halfband form
+    const double estimate = (attenuationDb - 7.95) / (14.36 * transition) + 1.0;
+    const int numPairs = std::max(1, static_cast<int>(std::ceil((estimate + 1.0) / 4.0)));
+
+    numTaps = 4 * numPairs - 1;
+
+    const int centre = (numTaps - 1) / 2;
+    const double beta = attenuationDb > 50.0 ? 0.1102 * (attenuationDb - 8.7)
+                                             : 0.5842 * std::pow(attenuationDb - 21.0, 0.4) + 0.07886 * (attenuationDb - 21.0);
+    const double windowScale = 1.0 / besselI0(beta);
+
+    pairTaps.resize(static_cast<size_t>(numPairs));
+
+    // h[centre +/- d] = sinc(d / 2) / 2 * window, non-zero for odd d only
+    double sum = 0.5;
+
+    for (int k = 0; k < numPairs; ++k)
+    {
+        const int d = 2 * k + 1;
+        const double ratio = static_cast<double>(d) / centre;
+        const double window = besselI0(beta * std::sqrt(std::max(0.0, 1.0 - ratio * ratio))) * windowScale;
+        const double x = 3.14159265358979323846 * d / 2.0;
+        const double tap = 0.5 * std::sin(x) / x * window;
+
+        pairTaps[static_cast<size_t>(k)] = static_cast<float>(tap);
+        sum += 2.0 * tap;
+    }
+
+    // Unity gain at DC; the centre tap stays 0.5 / sum
+    for (auto& tap : pairTaps)
+        tap = static_cast<float>(tap / sum);
+
+    centreTap = static_cast<float>(0.5 / sum);
+
+    history.assign(static_cast<size_t>(2 * numTaps), 0.0f);
+    reset();
+}
+
+void HalfbandDecimator::reset() noexcept
+{
+    std::fill(history.begin(), history.end(), 0.0f);
+    writePosition = 0;
+    outputDue = false;
+}
+
+int HalfbandDecimator::process(const float* input, int numInput, float* output) noexcept
+{
+    const int centre = (numTaps - 1) / 2;
+    const int numPairs = static_cast<int>(pairTaps.size());
+    int numOutput = 0;
+
+    for (int i = 0; i < numInput; ++i)
+    {
+        history[static_cast<size_t>(writePosition)] = input[i];
+        history[static_cast<size_t>(writePosition + numTaps)] = input[i];
+
+        if (++writePosition == numTaps)
+            writePosition = 0;
+
+        outputDue = !outputDue;
+
+        if (!outputDue)
+            continue;
+
+        // Oldest to newest: the mirrored copy makes the window contiguous
+        const float* window = history.data() + writePosition;
+        float sum = centreTap * window[centre];
+
+        for (int k = 0; k < numPairs; ++k)
+            sum += pairTaps[static_cast<size_t>(k)] * (window[centre - 1 - 2 * k] + window[centre + 1 + 2 * k]);
+
+        output[numOutput++] = sum;
+    }
+
+    return numOutput;
+}
+
+//==============================================================================
+void DecimatorCascade::prepare(double hostRate, int maxBlockSizeToUse,
+                               double minimumOutputRate, double passbandHz, double attenuationDb)
+{
+    maxBlockSize = std::max(1, maxBlockSizeToUse);
+    numStages = 0;
+    outputRate = hostRate;
+
+    while (numStages < maxStages && outputRate * 0.5 >= minimumOutputRate)
+    {
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            stages[static_cast<size_t>(channel)][static_cast<size_t>(numStages)].prepare(outputRate, passbandHz, attenuationDb);
+            buffers[static_cast<size_t>(channel)][static_cast<size_t>(numStages)].assign(static_cast<size_t>(maxBlockSize / 2 + 2), 0.0f);
+        }
+
+        outputRate *= 0.5;
+        ++numStages;
+    }
+
+    reset();
+}
+
+void DecimatorCascade::reset() noexcept
+{
+    for (auto& channelStages : stages)
+        for (int s = 0; s < numStages; ++s)
+            channelStages[static_cast<size_t>(s)].reset();
+
+    numOutputs.fill(0);
+}
+
+int DecimatorCascade::process(const float* left, const float* right, int numSamples) noexcept
+{
+    if (numStages == 0)
+        return 0;
+
+    numSamples = std::min(numSamples, maxBlockSize);
+
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        auto& channelStages = stages[static_cast<size_t>(channel)];
+        auto& channelBuffers = buffers[static_cast<size_t>(channel)];
+
+        const float* input = channel == 0 ? left : right;
+        int numInput = numSamples;
+
+        for (int s = 0; s < numStages; ++s)
+        {
+            float* output = channelBuffers[static_cast<size_t>(s)].data();
+            numInput = channelStages[static_cast<size_t>(s)].process(input, numInput, output);
+            input = output;
+        }
+
+        numOutputs[static_cast<size_t>(channel)] = numInput;
+    }
+
+    return numOutputs[0];
+}
+
+const float* DecimatorCascade::getOutput(int channel) const noexcept
+{
+    return buffers[static_cast<size_t>(channel)][static_cast<size_t>(numStages - 1)].data();
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <array>
+#include <vector>
+
+//==============================================================================
+// Streaming 2:1 decimator with a linear-phase halfband FIR (Kaiser-windowed).
+// Every other tap of a halfband filter is zero, and the rest are symmetric, so
+// each output costs one multiply per pair of non-zero taps. The filter length
+// follows from the band that must stay alias-free: everything that would fold
+// into 0..passbandHz is attenuated by at least the requested amount.
+class HalfbandDecimator
+{
+public:
+    //==============================================================================
+    // Designs the filter; allocates
+    void prepare(double inputRate, double passbandHz, double attenuationDb);
+    void reset() noexcept;
+
+    int getNumTaps() const noexcept { return numTaps; }
+
+    // Consumes numInput samples and writes one output per two inputs (phase is
+    // kept across calls). output needs room for numInput / 2 + 1 values.
+    // Returns the number of outputs written.
+    int process(const float* input, int numInput, float* output) noexcept;
+
+private:
+    //==============================================================================
+    std::vector<float> pairTaps;  // Taps at odd distances 1, 3, 5... from the centre
+    float centreTap = 0.5f;
+    std::vector<float> history;   // Last numTaps inputs, stored twice so a window is contiguous
+    int numTaps = 0;
+    int writePosition = 0;
+    bool outputDue = false;
+};
+
+//==============================================================================
+// Halfband stages for both analysis channels that bring a high host rate down
+// to the 44.1/48 kHz range: none at 44.1-64 kHz, one at 88.2/96 kHz, two at
+// 176.4/192 kHz, three at 352.8/384 kHz. Only 0..passbandHz is kept alias-free;
+// anything folding above that is never displayed.
+class DecimatorCascade
+{
+public:
+    //==============================================================================
+    static constexpr int maxStages = 3;
+    static constexpr int numChannels = 2;
+
+    // Allocates; maxBlockSize bounds numSamples per process() call
+    void prepare(double hostRate, int maxBlockSize,
+                 double minimumOutputRate = 44100.0,
+                 double passbandHz = 20000.0,
+                 double attenuationDb = 110.0);
+    void reset() noexcept;
+
+    int getNumStages() const noexcept { return numStages; }
+    int getFactor() const noexcept { return 1 << numStages; }
+    double getOutputRate() const noexcept { return outputRate; }
+    int getMaxBlockSize() const noexcept { return maxBlockSize; }
+
+    // Decimates one block (numSamples <= getMaxBlockSize()); returns the number
+    // of output samples, valid in getOutput() until the next call
+    int process(const float* left, const float* right, int numSamples) noexcept;
+    const float* getOutput(int channel) const noexcept;
+
+private:
+    //==============================================================================
+    std::array<std::array<HalfbandDecimator, maxStages>, numChannels> stages;
+    std::array<std::array<std::vector<float>, maxStages>, numChannels> buffers;
+    std::array<int, numChannels> numOutputs {};
+    int numStages = 0;
+    int maxBlockSize = 0;
+    double outputRate = 0.0;
+};
@@ -0,0 +1,55 @@
+#include "LatencyMonitor.h"
+#include <algorithm>
+#include <cmath>
+
+//==============================================================================
+void LatencyMonitor::addSample(double latencyMs) noexcept
+{
+    latencyMs = std::max(0.0, latencyMs);
+
+    const auto bucket = std::min(static_cast<int>(latencyMs / bucketWidthMs), numBuckets);
+    ++buckets[static_cast<size_t>(bucket)];
+
+    if (count == 0)
+    {
+        minimum = latencyMs;
+        maximum = latencyMs;
+    }
+    else
+    {
+        minimum = std::min(minimum, latencyMs);
+        maximum = std::max(maximum, latencyMs);
+    }
+
+    sum += latencyMs;
+    ++count;
+}
+
+void LatencyMonitor::reset() noexcept
+{
+    buckets.fill(0);
+    count = 0;
+    sum = 0.0;
+    minimum = 0.0;
+    maximum = 0.0;
+}
+
+double LatencyMonitor::getPercentile(double fraction) const noexcept
+{
+    if (count == 0)
+        return 0.0;
+
+    const auto target = static_cast<int64_t>(std::ceil(std::clamp(fraction, 0.0, 1.0) * static_cast<double>(count)));
+    int64_t seen = 0;
+
+    for (int i = 0; i < numBuckets; ++i)
+    {
+        seen += buckets[static_cast<size_t>(i)];
+
+        if (seen >= target && seen > 0)
+            return std::min(static_cast<double>(i + 1) * bucketWidthMs, maximum);
+    }
+
+    // Overflow bucket: the best we know is the observed maximum
+    return maximum;
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+//==============================================================================
+// Fixed-size latency histogram with 0.5 ms buckets up to 250 ms. Recording is
+// O(1) and never allocates, so it can sit directly in the display path.
+class LatencyMonitor
+{
+public:
+    //==============================================================================
+    static constexpr double bucketWidthMs = 0.5;
+    static constexpr int numBuckets = 500;
+
+    //==============================================================================
+    void addSample(double latencyMs) noexcept;
+    void reset() noexcept;
+
+    int64_t getNumSamples() const noexcept { return count; }
+    double getMinimum() const noexcept { return count > 0 ? minimum : 0.0; }
+    double getMaximum() const noexcept { return count > 0 ? maximum : 0.0; }
+    double getMean() const noexcept { return count > 0 ? sum / static_cast<double>(count) : 0.0; }
+
+    // Upper edge of the bucket holding the given fraction (0..1) of samples
+    double getPercentile(double fraction) const noexcept;
+
+private:
+    //==============================================================================
+    std::array<int64_t, numBuckets + 1> buckets {};  // Last bucket collects overflow
+    int64_t count = 0;
+    double sum = 0.0;
+    double minimum = 0.0;
+    double maximum = 0.0;
+};
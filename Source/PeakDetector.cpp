@@ -0,0 +1,68 @@
+#include "PeakDetector.h"
+#include <algorithm>
+
+//==============================================================================
+void PeakDetector::setNumPeaksToFind(int numPeaks) noexcept
+{
+    numPeaksToFind = std::clamp(numPeaks, 0, maxPeaks);
+    numFound = std::min(numFound, numPeaksToFind);
+}
+
+void PeakDetector::process(const float* magnitudesDb, int numBins, double sampleRate, int fftSize) noexcept
+{
+    numFound = 0;
+
+    if (magnitudesDb == nullptr || numBins < 3 || fftSize <= 0 || numPeaksToFind == 0)
+        return;
+
+    const float binWidth = static_cast<float>(sampleRate) / static_cast<float>(fftSize);
+
+    for (int i = 1; i < numBins - 1; ++i)
+    {
+        const float centre = magnitudesDb[i];
+
+        if (centre < thresholdDb)
+            continue;
+
+        const float left = magnitudesDb[i - 1];
+        const float right = magnitudesDb[i + 1];
+
+        // Strict on the left so a flat-topped pair only reports once
+        if (!(centre > left && centre >= right))
+            continue;
+
+        // Parabola through the three dB values: vertex offset in [-0.5, 0.5]
+        const float denominator = left - 2.0f * centre + right;
+        float offset = 0.0f;
+
+        if (denominator < 0.0f)
+            offset = std::clamp(0.5f * (left - right) / denominator, -0.5f, 0.5f);
+
+        Peak peak;
+        peak.bin = static_cast<float>(i) + offset;
+        peak.frequency = peak.bin * binWidth;
+        peak.level = centre - 0.25f * (left - right) * offset;
+
+        insertPeak(peak);
+    }
+}
+
+void PeakDetector::insertPeak(const Peak& peak) noexcept
+{
+    // Keep the list sorted by level; N is tiny so insertion is cheapest
+    int position = numFound;
+
+    while (position > 0 && peaks[static_cast<size_t>(position - 1)].level < peak.level)
+        --position;
+
+    if (position >= numPeaksToFind)
+        return;
+
+    const int last = std::min(numFound, numPeaksToFind - 1);
+
+    for (int i = last; i > position; --i)
+        peaks[static_cast<size_t>(i)] = peaks[static_cast<size_t>(i - 1)];
+
+    peaks[static_cast<size_t>(position)] = peak;
+    numFound = std::min(numFound + 1, numPeaksToFind);
+}
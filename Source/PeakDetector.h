@@ -0,0 +1,49 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+
+//==============================================================================
+// Finds the strongest local maxima of a dB magnitude spectrum and refines each
+// one to sub-bin accuracy. Fitting a parabola to the log magnitude of the three
+// bins around a maximum is a Gaussian fit of the main lobe, which is close to
+// exact for the Hann window, so tones are read to a small fraction of a bin
+// without a larger FFT.
+class PeakDetector
+{
+public:
+    //==============================================================================
+    static constexpr int maxPeaks = 8;
+
+    struct Peak
+    {
+        float frequency = 0.0f;  // Hz
+        float level = -100.0f;   // dB
+        float bin = 0.0f;        // Fractional bin index
+    };
+
+    //==============================================================================
+    void setThreshold(float newThresholdDb) noexcept { thresholdDb = newThresholdDb; }
+    float getThreshold() const noexcept { return thresholdDb; }
+
+    void setNumPeaksToFind(int numPeaks) noexcept;
+    int getNumPeaksToFind() const noexcept { return numPeaksToFind; }
+
+    // Scans bins [1, numBins - 2] of a dB spectrum from an fftSize-point transform
+    void process(const float* magnitudesDb, int numBins, double sampleRate, int fftSize) noexcept;
+
+    // Peaks found by the last call to process(), strongest first
+    int getNumPeaks() const noexcept { return numFound; }
+    const Peak& getPeak(int index) const noexcept { return peaks[static_cast<size_t>(index)]; }
+
+    void clear() noexcept { numFound = 0; }
+
+private:
+    //==============================================================================
+    void insertPeak(const Peak& peak) noexcept;
+
+    std::array<Peak, maxPeaks> peaks;
+    int numFound = 0;
+    int numPeaksToFind = 5;
+    float thresholdDb = -70.0f;
+};
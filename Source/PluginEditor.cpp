@@ -1,6 +1,31 @@
 #include "PluginProcessor.h"
 #include "PluginEditor.h"
 
+namespace
+{
+    // Restored values need not be on the menu (older or hand-edited state),
+    // so select the item nearest to them rather than leave the box blank
+    void selectNearestItem(juce::ComboBox& box, double value)
+    {
+        int nearestId = 0;
+        double nearestDistance = 0.0;
+
+        for (int i = 0; i < box.getNumItems(); ++i)
+        {
+            const int id = box.getItemId(i);
+            const double distance = std::abs(static_cast<double>(id) - value);
+
+            if (nearestId == 0 || distance < nearestDistance)
+            {
+                nearestId = id;
+                nearestDistance = distance;
+            }
+        }
+
+        box.setSelectedId(nearestId, juce::dontSendNotification);
+    }
+}
+
 //==============================================================================
 SpectrumAnalyzerAudioProcessorEditor::SpectrumAnalyzerAudioProcessorEditor(SpectrumAnalyzerAudioProcessor& p)
     : AudioProcessorEditor(&p),
@@ -9,24 +34,168 @@ SpectrumAnalyzerAudioProcessorEditor::SpectrumAnalyzerAudioProcessorEditor(Spect
 {
     // Setup Peak Hold button
     peakHoldButton.setButtonText("Peak Hold");
-    peakHoldButton.setToggleState(true, juce::dontSendNotification);
     peakHoldButton.onClick = [this]()
     {
         spectrumComponent.setPeakHoldEnabled(peakHoldButton.getToggleState());
     };
     addAndMakeVisible(peakHoldButton);
     
+    // Setup Peak Markers button
+    peakMarkersButton.setButtonText("Markers");
+    peakMarkersButton.onClick = [this]()
+    {
+        spectrumComponent.setPeakMarkersEnabled(peakMarkersButton.getToggleState());
+    };
+    addAndMakeVisible(peakMarkersButton);
+    
+    // Setup Low Latency button
+    lowLatencyButton.setButtonText("Low Latency");
+    lowLatencyButton.onClick = [this]()
+    {
+        spectrumComponent.setLowLatencyMode(lowLatencyButton.getToggleState());
+    };
+    addAndMakeVisible(lowLatencyButton);
+    
+    // Setup frequency weighting selector (item IDs are Weighting + 1)
+    weightingBox.addItemList({ "Z-Wt", "A-Wt", "C-Wt" }, 1);
+    weightingBox.onChange = [this]()
+    {
+        auto settings = spectrumComponent.getAnalysisSettings();
+        settings.weighting = static_cast<AnalysisSettings::Weighting>(weightingBox.getSelectedId() - 1);
+        spectrumComponent.setAnalysisSettings(settings);
+    };
+    addAndMakeVisible(weightingBox);
+    
+    // Setup octave smoothing selector (item IDs are the octave fraction + 1, 1 = off)
+    smoothingBox.addItem("No Smooth", 1);
+    smoothingBox.addItem("1/24 oct", 25);
+    smoothingBox.addItem("1/12 oct", 13);
+    smoothingBox.addItem("1/6 oct", 7);
+    smoothingBox.addItem("1/3 oct", 4);
+    smoothingBox.onChange = [this]()
+    {
+        auto settings = spectrumComponent.getAnalysisSettings();
+        settings.octaveFraction = smoothingBox.getSelectedId() - 1;
+        spectrumComponent.setAnalysisSettings(settings);
+    };
+    addAndMakeVisible(smoothingBox);
+    
+    // Setup history trace selector (item IDs are HistoryDisplay + 1)
+    historyTraceBox.addItemList({ "No Trace", "Max", "Min", "Min / Max", "Average", "Infinite Avg" }, 1);
+    historyTraceBox.onChange = [this]()
+    {
+        const auto display = static_cast<SpectrumAnalyzerComponent::HistoryDisplay>(historyTraceBox.getSelectedId() - 1);
+        spectrumComponent.setHistoryDisplay(display);
+    };
+    addAndMakeVisible(historyTraceBox);
+    
+    // Setup history window selector (item IDs are seconds)
+    historyWindowBox.addItem("1 s", 1);
+    historyWindowBox.addItem("3 s", 3);
+    historyWindowBox.addItem("10 s", 10);
+    historyWindowBox.addItem("30 s", 30);
+    historyWindowBox.addItem("1 min", 60);
+    historyWindowBox.addItem("5 min", 300);
+    historyWindowBox.onChange = [this]()
+    {
+        spectrumComponent.setHistoryWindowSeconds(static_cast<double>(historyWindowBox.getSelectedId()));
+    };
+    addAndMakeVisible(historyWindowBox);
+    
+    // Setup Stereo analysis button
+    stereoButton.setButtonText("Stereo");
+    stereoButton.onClick = [this]()
+    {
+        spectrumComponent.setStereoAnalysisEnabled(stereoButton.getToggleState());
+    };
+    addAndMakeVisible(stereoButton);
+    
+    // Setup local stream server button (127.0.0.1, default port)
+    streamButton.setButtonText("Stream");
+    streamButton.onClick = [this]()
+    {
+        if (!streamButton.getToggleState())
+            audioProcessor.stopStreaming();
+        else if (!audioProcessor.startStreaming())
+            streamButton.setToggleState(false, juce::dontSendNotification);  // Port in use
+    };
+    addAndMakeVisible(streamButton);
+    
+    // Setup sample-rate-adaptive analysis button (decimates 88.2 kHz and up)
+    rateAdaptiveButton.setButtonText("Adaptive SR");
+    rateAdaptiveButton.onClick = [this]()
+    {
+        audioProcessor.setRateAdaptive(rateAdaptiveButton.getToggleState());
+    };
+    addAndMakeVisible(rateAdaptiveButton);
+    
+    // Setup Freeze / reference controls
+    freezeButton.setButtonText("Freeze");
+    freezeButton.onClick = [this]()
+    {
+        spectrumComponent.setFrozen(freezeButton.getToggleState());
+    };
+    addAndMakeVisible(freezeButton);
+    
+    captureButton.setButtonText("Capture");
+    captureButton.onClick = [this]()
+    {
+        spectrumComponent.captureReference();
+    };
+    addAndMakeVisible(captureButton);
+    
+    clearButton.setButtonText("Clear");
+    clearButton.onClick = [this]()
+    {
+        spectrumComponent.clearReferences();
+    };
+    addAndMakeVisible(clearButton);
+    
+    differenceButton.setButtonText("Diff");
+    differenceButton.onClick = [this]()
+    {
+        spectrumComponent.setDifferenceEnabled(differenceButton.getToggleState());
+    };
+    addAndMakeVisible(differenceButton);
+    
     // Add spectrum component
     addAndMakeVisible(spectrumComponent);
     
+    // Controls show the processor's state, now and whenever the host restores it
+    updateControls();
+    audioProcessor.addChangeListener(this);
+    
     // Set window size
     setSize(defaultWidth, defaultHeight);
     setResizable(true, true);
-    setResizeLimits(300, 200, 1200, 800);
+    setResizeLimits(minimumWidth, 200, 1200, 800);
 }
 
 SpectrumAnalyzerAudioProcessorEditor::~SpectrumAnalyzerAudioProcessorEditor()
 {
+    audioProcessor.removeChangeListener(this);
+}
+
+//==============================================================================
+void SpectrumAnalyzerAudioProcessorEditor::updateControls()
+{
+    const auto& settings = spectrumComponent.getAnalysisSettings();
+    
+    peakHoldButton.setToggleState(settings.peakHoldEnabled, juce::dontSendNotification);
+    peakMarkersButton.setToggleState(spectrumComponent.arePeakMarkersEnabled(), juce::dontSendNotification);
+    lowLatencyButton.setToggleState(audioProcessor.isLowLatencyMode(), juce::dontSendNotification);
+    weightingBox.setSelectedId(static_cast<int>(settings.weighting) + 1, juce::dontSendNotification);
+    selectNearestItem(smoothingBox, settings.octaveFraction + 1);
+    historyTraceBox.setSelectedId(static_cast<int>(spectrumComponent.getHistoryDisplay()) + 1, juce::dontSendNotification);
+    selectNearestItem(historyWindowBox, spectrumComponent.getHistoryWindowSeconds());
+    stereoButton.setToggleState(settings.stereoAnalysisEnabled, juce::dontSendNotification);
+    streamButton.setToggleState(audioProcessor.isStreaming(), juce::dontSendNotification);
+    rateAdaptiveButton.setToggleState(audioProcessor.isRateAdaptive(), juce::dontSendNotification);
+}
+
+void SpectrumAnalyzerAudioProcessorEditor::changeListenerCallback(juce::ChangeBroadcaster*)
+{
+    updateControls();
 }
 
 //==============================================================================
@@ -66,6 +235,17 @@ void SpectrumAnalyzerAudioProcessorEditor::paint(juce::Graphics& g)
     // Core line
     g.setColour(juce::Colour(0xFF00FFFF));
     g.drawLine(0, sepY, w, sepY, 1.0f);
+    
+    // Control bar below the header
+    g.setColour(juce::Colour(0xFF100A1C));
+    g.fillRect(0, headerHeight, getWidth(), controlBarHeight);
+    
+    g.setFont(juce::Font(11.0f, juce::Font::bold));
+    g.setColour(juce::Colour(0xFF00CCFF));
+    g.drawText("HISTORY", 12, headerHeight, 60, controlBarHeight, juce::Justification::centredLeft);
+    
+    g.setColour(juce::Colour(0x4000FFFF));
+    g.drawHorizontalLine(headerHeight + controlBarHeight - 1, 0.0f, w);
 }
 
 void SpectrumAnalyzerAudioProcessorEditor::resized()
@@ -77,6 +257,26 @@ void SpectrumAnalyzerAudioProcessorEditor::resized()
     
     // Peak Hold button - right side of header
     peakHoldButton.setBounds(headerArea.removeFromRight(120).reduced(10, 8));
+    peakMarkersButton.setBounds(headerArea.removeFromRight(100).reduced(10, 8));
+    lowLatencyButton.setBounds(headerArea.removeFromRight(120).reduced(10, 8));
+    smoothingBox.setBounds(headerArea.removeFromRight(92).reduced(2, 5));
+    weightingBox.setBounds(headerArea.removeFromRight(68).reduced(2, 5));
+    
+    // Control bar - history selectors on the left
+    auto controlBar = bounds.removeFromTop(controlBarHeight);
+    controlBar.removeFromLeft(70);
+    historyTraceBox.setBounds(controlBar.removeFromLeft(120).reduced(2, 3));
+    historyWindowBox.setBounds(controlBar.removeFromLeft(80).reduced(2, 3));
+    controlBar.removeFromLeft(10);
+    stereoButton.setBounds(controlBar.removeFromLeft(80).reduced(2, 3));
+    streamButton.setBounds(controlBar.removeFromLeft(80).reduced(2, 3));
+    rateAdaptiveButton.setBounds(controlBar.removeFromLeft(110).reduced(2, 3));
+    
+    // Reference controls on the right
+    differenceButton.setBounds(controlBar.removeFromRight(60).reduced(2, 3));
+    clearButton.setBounds(controlBar.removeFromRight(56).reduced(2, 3));
+    captureButton.setBounds(controlBar.removeFromRight(66).reduced(2, 3));
+    freezeButton.setBounds(controlBar.removeFromRight(76).reduced(2, 3));
     
     // Spectrum component takes the rest
     spectrumComponent.setBounds(bounds);
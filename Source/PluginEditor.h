@@ -6,7 +6,8 @@
 class SpectrumAnalyzerAudioProcessor;
 
 //==============================================================================
-class SpectrumAnalyzerAudioProcessorEditor : public juce::AudioProcessorEditor
+class SpectrumAnalyzerAudioProcessorEditor : public juce::AudioProcessorEditor,
+                                             private juce::ChangeListener
 {
 public:
     explicit SpectrumAnalyzerAudioProcessorEditor(SpectrumAnalyzerAudioProcessor&);
@@ -17,16 +18,34 @@ public:
     void resized() override;
 
 private:
+    void changeListenerCallback(juce::ChangeBroadcaster* source) override;
+    void updateControls();
+
     SpectrumAnalyzerAudioProcessor& audioProcessor;
 
     // UI Components
     SpectrumAnalyzerComponent spectrumComponent;
     juce::ToggleButton peakHoldButton;
+    juce::ToggleButton peakMarkersButton;
+    juce::ToggleButton lowLatencyButton;
+    juce::ComboBox weightingBox;
+    juce::ComboBox smoothingBox;
+    juce::ComboBox historyTraceBox;
+    juce::ComboBox historyWindowBox;
+    juce::ToggleButton stereoButton;
+    juce::ToggleButton streamButton;
+    juce::ToggleButton rateAdaptiveButton;
+    juce::ToggleButton freezeButton;
+    juce::TextButton captureButton;
+    juce::TextButton clearButton;
+    juce::ToggleButton differenceButton;
 
     // Constants
     static constexpr int headerHeight = 32;
-    static constexpr int defaultWidth = 500;
-    static constexpr int defaultHeight = 300;
+    static constexpr int controlBarHeight = 28;
+    static constexpr int defaultWidth = 820;
+    static constexpr int minimumWidth = 820;  // Control bar slots take 808 px, the header about 700
+    static constexpr int defaultHeight = 330;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SpectrumAnalyzerAudioProcessorEditor)
 };
@@ -2,20 +2,30 @@
 #include "PluginEditor.h"
 #include <cmath>
 
+static_assert(SpectrumSnapshot::fftSize == SpectrumAnalyzerAudioProcessor::fftSize,
+              "Analysis and processor must agree on the FFT size");
+
 //==============================================================================
 SpectrumAnalyzerAudioProcessor::SpectrumAnalyzerAudioProcessor()
     : AudioProcessor(BusesProperties()
                      .withInput("Input", juce::AudioChannelSet::stereo(), true)
-                     .withOutput("Output", juce::AudioChannelSet::stereo(), true)),
-      fft(fftOrder)
+                     .withOutput("Output", juce::AudioChannelSet::stereo(), true))
 {
     initializeHannWindow();
-    fifo.fill(0.0f);
-    fftData.fill(0.0f);
+
+    for (auto& channelFifo : fifo)
+        channelFifo.fill(0.0f);
+
+    for (auto& channelData : fftData)
+        channelData.fill(0.0f);
 }
 
 SpectrumAnalyzerAudioProcessor::~SpectrumAnalyzerAudioProcessor()
 {
+    stopStreaming();
+
+    if (scheduled)
+        scheduler->removeClient(this);
 }
 
 //==============================================================================
@@ -82,10 +92,27 @@ void SpectrumAnalyzerAudioProcessor::changeProgramName(int index, const juce::St
 //==============================================================================
 void SpectrumAnalyzerAudioProcessor::prepareToPlay(double sampleRate, int samplesPerBlock)
 {
-    juce::ignoreUnused(sampleRate, samplesPerBlock);
+    hostSampleRate = sampleRate > 0 ? sampleRate : 44100.0;
+
+    // Sized for the host block; larger blocks are decimated in pieces
+    decimator.prepare(hostSampleRate, juce::jmax(1, samplesPerBlock));
+    decimating = false;
+    analysisSampleRate = hostSampleRate;
+
+    resetFifo();
+
+    // fftData is left alone: while the ready flag is set it belongs to the GUI,
+    // and the next capture overwrites it anyway
+}
+
+void SpectrumAnalyzerAudioProcessor::resetFifo() noexcept
+{
     fifoIndex = 0;
-    fifo.fill(0.0f);
-    fftData.fill(0.0f);
+    samplesSinceLastFrame = 0;
+    samplesFrameBlocked = 0;
+
+    for (auto& channelFifo : fifo)
+        channelFifo.fill(0.0f);
 }
 
 void SpectrumAnalyzerAudioProcessor::releaseResources()
@@ -111,6 +138,10 @@ void SpectrumAnalyzerAudioProcessor::processBlock(juce::AudioBuffer<float>& buff
 
     juce::ScopedNoDenormals noDenormals;
 
+    // Every sample in this block reaches us now; frames completed here inherit this time
+    currentBlockTimestamp = juce::Time::getHighResolutionTicks();
+    hopSize = lowLatencyMode.load(std::memory_order_relaxed) ? lowLatencyHopSize : fftSize;
+
     auto totalNumInputChannels = getTotalNumInputChannels();
     auto totalNumOutputChannels = getTotalNumOutputChannels();
 
@@ -118,48 +149,193 @@ void SpectrumAnalyzerAudioProcessor::processBlock(juce::AudioBuffer<float>& buff
     for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
         buffer.clear(i, 0, buffer.getNumSamples());
 
-    // Mix all channels to mono and push to FIFO
+    // Switching between host-rate and decimated samples: the history no longer
+    // matches, so start it (and the filter state) afresh
+    const bool shouldDecimate = rateAdaptive.load(std::memory_order_relaxed) && decimator.getNumStages() > 0;
+
+    if (shouldDecimate != decimating)
+    {
+        decimating = shouldDecimate;
+        analysisSampleRate = decimating ? decimator.getOutputRate() : hostSampleRate;
+        decimator.reset();
+        resetFifo();
+    }
+
+    // Push left and right to the FIFO; mono input feeds both channels
     if (totalNumInputChannels > 0)
     {
         const int numSamples = buffer.getNumSamples();
+        const float* left = buffer.getReadPointer(0);
+        const float* right = buffer.getReadPointer(totalNumInputChannels > 1 ? 1 : 0);
+        currentBlockIsStereo = totalNumInputChannels > 1;
         
-        for (int sample = 0; sample < numSamples; ++sample)
+        if (decimating)
+        {
+            const int chunkSize = decimator.getMaxBlockSize();
+
+            for (int start = 0; start < numSamples; start += chunkSize)
+            {
+                const int numOutput = decimator.process(left + start, right + start,
+                                                        juce::jmin(chunkSize, numSamples - start));
+                const float* decimatedLeft = decimator.getOutput(0);
+                const float* decimatedRight = decimator.getOutput(1);
+
+                for (int sample = 0; sample < numOutput; ++sample)
+                    pushNextSampleIntoFifo(decimatedLeft[sample], decimatedRight[sample]);
+            }
+        }
+        else
         {
-            float monoSample = 0.0f;
-            
-            for (int channel = 0; channel < totalNumInputChannels; ++channel)
+            for (int sample = 0; sample < numSamples; ++sample)
             {
-                monoSample += buffer.getSample(channel, sample);
+                pushNextSampleIntoFifo(left[sample], right[sample]);
             }
-            
-            monoSample /= static_cast<float>(totalNumInputChannels);
-            pushNextSampleIntoFifo(monoSample);
         }
     }
 }
 
-void SpectrumAnalyzerAudioProcessor::pushNextSampleIntoFifo(float sample) noexcept
+void SpectrumAnalyzerAudioProcessor::pushNextSampleIntoFifo(float left, float right) noexcept
 {
-    if (fifoIndex == fftSize)
+    fifo[0][fifoIndex] = left;
+    fifo[1][fifoIndex] = right;
+
+    if (++fifoIndex == fftSize)
+        fifoIndex = 0;
+
+    // Take a frame once a full hop of new samples has arrived. If the GUI is still
+    // holding the previous frame we keep counting, so the next frame is taken the
+    // moment it is released and is never older than necessary.
+    if (samplesSinceLastFrame < hopSize)
+        ++samplesSinceLastFrame;
+
+    if (samplesSinceLastFrame >= hopSize && nextFFTBlockReady.load())
     {
-        if (!nextFFTBlockReady.load())
+        // Every further hop spent waiting for the GUI is a frame that never gets analysed
+        if (++samplesFrameBlocked >= hopSize)
         {
-            // Copy FIFO data to FFT data buffer with Hann window applied
-            for (int i = 0; i < fftSize; ++i)
+            samplesFrameBlocked = 0;
+            framesDropped.store(framesDropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        }
+    }
+    else if (samplesSinceLastFrame >= hopSize)
+    {
+        // Unwrap the circular history (oldest sample first) with Hann window applied
+        const int firstPart = fftSize - fifoIndex;
+
+        for (int channel = 0; channel < numAnalysisChannels; ++channel)
+        {
+            const auto& channelFifo = fifo[static_cast<size_t>(channel)];
+            auto& channelData = fftData[static_cast<size_t>(channel)];
+
+            for (int i = 0; i < firstPart; ++i)
             {
-                fftData[i] = fifo[i] * hannWindow[i];
+                channelData[i] = channelFifo[fifoIndex + i] * hannWindow[i];
             }
-            // Zero-pad the second half
-            for (int i = fftSize; i < fftSize * 2; ++i)
+            for (int i = firstPart; i < fftSize; ++i)
             {
-                fftData[i] = 0.0f;
+                channelData[i] = channelFifo[i - firstPart] * hannWindow[i];
             }
-            nextFFTBlockReady.store(true);
         }
-        fifoIndex = 0;
+
+        fftBlockTimestamp = currentBlockTimestamp;
+        fftBlockIsStereo = currentBlockIsStereo;
+        fftBlockSampleRate = analysisSampleRate;
+        samplesSinceLastFrame = 0;
+        samplesFrameBlocked = 0;
+        framesCaptured.store(framesCaptured.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        nextFFTBlockReady.store(true);
     }
+}
+
+//==============================================================================
+bool SpectrumAnalyzerAudioProcessor::analyseNextFrame()
+{
+    if (!nextFFTBlockReady.load())
+        return false;
+
+    const int frameHopSize = isLowLatencyMode() ? lowLatencyHopSize : fftSize;
+
+    analysisEngine.processFrame(fftData[0].data(), fftData[1].data(), fftBlockIsStereo,
+                                fftBlockSampleRate, frameHopSize, fftBlockTimestamp);
+    resetFFTBlockReady();
 
-    fifo[fifoIndex++] = sample;
+    if (streamServer.isRunning())
+        streamServer.publish(analysisEngine.getSnapshot());
+
+    return true;
+}
+
+bool SpectrumAnalyzerAudioProcessor::startStreaming(int port)
+{
+    if (!streamServer.start(port))
+        return false;
+
+    updateScheduling();
+    return true;
+}
+
+void SpectrumAnalyzerAudioProcessor::stopStreaming()
+{
+    streamServer.stop();
+    updateScheduling();
+}
+
+void SpectrumAnalyzerAudioProcessor::addDisplayListener(SpectrumDisplaySource::Listener* listener)
+{
+    displayListeners.add(listener);
+    updateScheduling();
+}
+
+void SpectrumAnalyzerAudioProcessor::removeDisplayListener(SpectrumDisplaySource::Listener* listener)
+{
+    displayListeners.remove(listener);
+    updateScheduling();
+}
+
+void SpectrumAnalyzerAudioProcessor::updateScheduling()
+{
+    // Ticks cost nothing to instances nobody is looking at
+    const bool shouldBeScheduled = !displayListeners.isEmpty() || isStreaming();
+
+    if (shouldBeScheduled == scheduled)
+        return;
+
+    scheduled = shouldBeScheduled;
+
+    if (scheduled)
+        scheduler->addClient(this);
+    else
+        scheduler->removeClient(this);
+}
+
+void SpectrumAnalyzerAudioProcessor::analysisTick(double elapsedSeconds)
+{
+    const auto captured = getNumFramesCaptured();
+    secondsSinceLastFrame = captured != lastFramesCaptured ? 0.0 : secondsSinceLastFrame + elapsedSeconds;
+    lastFramesCaptured = captured;
+
+    bool newFrame = false;
+    bool decayed = false;
+
+    {
+        const juce::ScopedLock sl(getEngineLock());
+        const auto& settings = analysisEngine.getSettings();
+
+        newFrame = analyseNextFrame();
+
+        // By elapsed time, so the decay is the same at every tick and frame rate
+        decayed = settings.peakHoldEnabled
+               && analysisEngine.decayPeakHold(settings.peakDecaydBPerSecond * static_cast<float>(elapsedSeconds));
+    }
+
+    if (newFrame || decayed)
+        displayListeners.call([newFrame](SpectrumDisplaySource::Listener& listener) { listener.analysisUpdated(newFrame); });
+}
+
+bool SpectrumAnalyzerAudioProcessor::wantsFastTicks() const
+{
+    // Overlapping frames arrive every few ms, but only while audio is flowing
+    return isLowLatencyMode() && secondsSinceLastFrame < framesExpectedSeconds;
 }
 
 //==============================================================================
@@ -176,12 +352,55 @@ juce::AudioProcessorEditor* SpectrumAnalyzerAudioProcessor::createEditor()
 //==============================================================================
 void SpectrumAnalyzerAudioProcessor::getStateInformation(juce::MemoryBlock& destData)
 {
-    juce::ignoreUnused(destData);
+    // Hosts save from any thread; the engine must hold still while we read it
+    const juce::ScopedLock sl(getEngineLock());
+
+    PluginState::Settings settings;
+    settings.analysis = analysisEngine.getSettings();
+    settings.lowLatencyMode = isLowLatencyMode();
+    settings.rateAdaptive = isRateAdaptive();
+    settings.peakMarkersEnabled = arePeakMarkersEnabled();
+    settings.historyDisplay = getHistoryDisplay();
+    settings.historyWindowSeconds = static_cast<float>(analysisEngine.getHistoryWindowSeconds());
+
+    // The engine's spectrum goes along so a reloaded session opens warm. With
+    // no editor open and no stream it is the one from when the editor closed.
+    PluginState::Traces traces;
+    traces.sampleRate = analysisEngine.getSnapshot().sampleRate;
+    traces.latestFrame = analysisEngine.getFrameData().data();
+    traces.smoothed = analysisEngine.getSnapshot().magnitude.data();
+    traces.peakHold = analysisEngine.getPeakHold().data();
+    traces.average = analysisEngine.getInfiniteAverage(traces.averageFrames);
+
+    const auto* tracesToSave = analysisEngine.hasTraces() ? &traces : nullptr;
+    destData.setSize(static_cast<size_t>(PluginState::getSize(tracesToSave)));
+    PluginState::write(settings, tracesToSave, destData.getData());
 }
 
 void SpectrumAnalyzerAudioProcessor::setStateInformation(const void* data, int sizeInBytes)
 {
-    juce::ignoreUnused(data, sizeInBytes);
+    // Reads the host's buffer in place; nothing here allocates
+    PluginState::View view;
+
+    if (!PluginState::read(data, sizeInBytes, view))
+        return;
+
+    const auto& settings = view.settings;
+    setLowLatencyMode(settings.lowLatencyMode);
+    setRateAdaptive(settings.rateAdaptive);
+    setPeakMarkersEnabled(settings.peakMarkersEnabled);
+    setHistoryDisplay(settings.historyDisplay);
+
+    // Hosts restore from any thread; the analysis tick and the editor wait
+    const juce::ScopedLock sl(getEngineLock());
+
+    analysisEngine.setSettings(settings.analysis);
+    analysisEngine.setHistoryWindowSeconds(settings.historyWindowSeconds);
+    analysisEngine.setHistoryEnabled(settings.historyDisplay != 0);
+    analysisEngine.restoreTraces(view);
+
+    // Asynchronous; an open editor refreshes its controls and display modes
+    sendChangeMessage();
 }
 
 //==============================================================================
@@ -4,14 +4,24 @@
 #include <juce_dsp/juce_dsp.h>
 #include <array>
 #include <atomic>
+#include "AnalysisScheduler.h"
+#include "HalfbandDecimator.h"
+#include "PluginState.h"
+#include "SpectrumAnalysisEngine.h"
+#include "SpectrumDisplaySource.h"
+#include "SpectrumStreamServer.h"
 
 //==============================================================================
-class SpectrumAnalyzerAudioProcessor : public juce::AudioProcessor
+class SpectrumAnalyzerAudioProcessor : public juce::AudioProcessor,
+                                       public SpectrumDisplaySource,
+                                       private AnalysisScheduler::Client
 {
 public:
     //==============================================================================
     static constexpr int fftOrder = 12;  // 2^12 = 4096
     static constexpr int fftSize = 1 << fftOrder;
+    static constexpr int lowLatencyHopSize = fftSize / 4;  // 75% overlap
+    static constexpr int numAnalysisChannels = 2;          // Left, right
 
     //==============================================================================
     SpectrumAnalyzerAudioProcessor();
@@ -45,35 +55,129 @@ public:
     void changeProgramName(int index, const juce::String& newName) override;
 
     //==============================================================================
+    // Safe from any thread: both hold the engine lock. The saved traces are
+    // the engine's, which only moves while an editor is open or the stream
+    // runs, so a session saved later restores the spectrum as it was then.
+    // Restoring state sends a change message so an open editor follows it.
     void getStateInformation(juce::MemoryBlock& destData) override;
     void setStateInformation(const void* data, int sizeInBytes) override;
 
     //==============================================================================
     // Thread-safe FIFO for passing data to GUI
-    void pushNextSampleIntoFifo(float sample) noexcept;
+    void pushNextSampleIntoFifo(float left, float right) noexcept;
     bool isNextFFTBlockReady() const noexcept { return nextFFTBlockReady.load(); }
     void resetFFTBlockReady() noexcept { nextFFTBlockReady.store(false); }
     
-    // Get FFT data for visualization
-    const std::array<float, fftSize * 2>& getFFTData() const noexcept { return fftData; }
-    std::array<float, fftSize * 2>& getFFTDataForWriting() noexcept { return fftData; }
+    // High resolution ticks of the processBlock that completed the ready frame
+    juce::int64 getFFTBlockTimestamp() const noexcept { return fftBlockTimestamp; }
     
-    // FFT object for GUI thread
-    juce::dsp::FFT& getFFT() noexcept { return fft; }
+    // Low-latency mode analyses overlapping frames every lowLatencyHopSize samples
+    void setLowLatencyMode(bool enabled) noexcept override { lowLatencyMode.store(enabled); }
+    bool isLowLatencyMode() const noexcept override { return lowLatencyMode.load(); }
+    
+    // Sample-rate-adaptive mode decimates high host rates (88.2 kHz and up) to
+    // 44.1/48 kHz before the FFT, so bin width, frame latency and CPU per second
+    // stay the same at every session rate. No effect at 44.1-64 kHz.
+    void setRateAdaptive(bool enabled) noexcept { rateAdaptive.store(enabled); }
+    bool isRateAdaptive() const noexcept { return rateAdaptive.load(); }
+    
+    // Rate of the samples in the ready frame (host rate / decimation factor)
+    double getFFTBlockSampleRate() const noexcept { return fftBlockSampleRate; }
+    
+    // Frames handed to the GUI, and frames skipped because the previous one was
+    // still unread (one per extra hop spent waiting). Written by the audio thread only.
+    juce::uint32 getNumFramesCaptured() const noexcept { return framesCaptured.load(std::memory_order_relaxed); }
+    juce::uint32 getNumFramesDropped() const noexcept { return framesDropped.load(std::memory_order_relaxed); }
+    
+    // Windowed real frame of one channel for visualization (fftSize samples, no padding)
+    const std::array<float, fftSize>& getFFTData(int channel) const noexcept { return fftData[static_cast<size_t>(channel)]; }
+    
+    // False when the ready frame came from mono input (both channels hold the same data)
+    bool isFFTBlockStereo() const noexcept { return fftBlockIsStereo; }
+    
+    // Analysis chain and its results; driven from the message thread under
+    // getEngineLock(), outlives the editor
+    SpectrumAnalysisEngine& getAnalysisEngine() noexcept { return analysisEngine; }
+    SpectrumAnalysisEngine* getDisplayedEngine() noexcept override { return &analysisEngine; }
+    
+    // Display choices kept here so they outlive the editor and are saved with
+    // the state
+    void setPeakMarkersEnabled(bool enabled) noexcept override { peakMarkersEnabled.store(enabled); }
+    bool arePeakMarkersEnabled() const noexcept override { return peakMarkersEnabled.load(); }
+    void setHistoryDisplay(int display) noexcept override { historyDisplay.store(display); }
+    int getHistoryDisplay() const noexcept override { return historyDisplay.load(); }
+    
+    // The shared AnalysisScheduler drives the analysis while a display listens
+    // or the stream runs
+    void addDisplayListener(SpectrumDisplaySource::Listener* listener) override;
+    void removeDisplayListener(SpectrumDisplaySource::Listener* listener) override;
+    
+    // Local spectrum stream on 127.0.0.1; remote displays keep updating with
+    // no editor open.
+    bool startStreaming(int port = SpectrumStreamProtocol::defaultPort);
+    void stopStreaming();
+    bool isStreaming() const noexcept { return streamServer.isRunning(); }
+    const SpectrumStreamServer& getStreamServer() const noexcept { return streamServer; }
     
     // Hann window
     const std::array<float, fftSize>& getHannWindow() const noexcept { return hannWindow; }
 
 private:
     //==============================================================================
-    juce::dsp::FFT fft;
-    std::array<float, fftSize> fifo;
-    std::array<float, fftSize * 2> fftData;
+    SpectrumAnalysisEngine analysisEngine;
+    SpectrumStreamServer streamServer;
+    
+    // Analysis ticks (message thread)
+    juce::SharedResourcePointer<AnalysisScheduler> scheduler;
+    juce::ListenerList<SpectrumDisplaySource::Listener> displayListeners;
+    bool scheduled = false;
+    juce::uint32 lastFramesCaptured = 0;
+    double secondsSinceLastFrame = 0.0;
+    
+    // Fast ticks stop once no frame has arrived for this long (transport stopped)
+    static constexpr double framesExpectedSeconds = 0.25;
+    
+    // Display state; also written by setStateInformation() on the host's thread
+    std::atomic<bool> peakMarkersEnabled { true };
+    std::atomic<int> historyDisplay { 0 };
+    
+    // Circular history of the last fftSize samples per channel
+    std::array<std::array<float, fftSize>, numAnalysisChannels> fifo;
+    std::array<std::array<float, fftSize>, numAnalysisChannels> fftData;
     std::array<float, fftSize> hannWindow;
     int fifoIndex = 0;
+    int samplesSinceLastFrame = 0;
+    int samplesFrameBlocked = 0;  // Samples since a due frame was last skipped
+    int hopSize = fftSize;
     std::atomic<bool> nextFFTBlockReady { false };
+    std::atomic<bool> lowLatencyMode { false };
+    std::atomic<bool> rateAdaptive { true };
+    std::atomic<juce::uint32> framesCaptured { 0 };
+    std::atomic<juce::uint32> framesDropped { 0 };
+    bool currentBlockIsStereo = false;
+    
+    // Audio thread only
+    DecimatorCascade decimator;
+    bool decimating = false;
+    double hostSampleRate = 44100.0;
+    double analysisSampleRate = 44100.0;
+    
+    // Frame info (written before nextFFTBlockReady is set)
+    juce::int64 currentBlockTimestamp = 0;
+    juce::int64 fftBlockTimestamp = 0;
+    bool fftBlockIsStereo = false;
+    double fftBlockSampleRate = 44100.0;
 
     void initializeHannWindow();
+    void resetFifo() noexcept;
+    
+    // Analyses the ready frame (if any), releases it and publishes the result
+    // to the stream server. Returns true if a frame was analysed.
+    bool analyseNextFrame();
+    void updateScheduling();
+    
+    void analysisTick(double elapsedSeconds) override;
+    bool wantsFastTicks() const override;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SpectrumAnalyzerAudioProcessor)
 };
@@ -0,0 +1,234 @@
+#include "PluginState.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace PluginState
+{
+    namespace
+    {
+        constexpr float traceScale = 65535.0f / (AnalysisStages::maxdB - AnalysisStages::mindB);
+
+        // Little-endian writes and reads that advance a cursor
+        void writeUint8(std::uint8_t*& dest, int value) noexcept
+        {
+            *dest++ = static_cast<std::uint8_t>(value);
+        }
+
+        void writeUint16(std::uint8_t*& dest, int value) noexcept
+        {
+            *dest++ = static_cast<std::uint8_t>(value & 0xff);
+            *dest++ = static_cast<std::uint8_t>((value >> 8) & 0xff);
+        }
+
+        void writeUint32(std::uint8_t*& dest, std::uint32_t value) noexcept
+        {
+            for (int shift = 0; shift < 32; shift += 8)
+                *dest++ = static_cast<std::uint8_t>((value >> shift) & 0xff);
+        }
+
+        void writeFloat(std::uint8_t*& dest, float value) noexcept
+        {
+            std::uint32_t bits;
+            std::memcpy(&bits, &value, sizeof(bits));
+            writeUint32(dest, bits);
+        }
+
+        void writeDouble(std::uint8_t*& dest, double value) noexcept
+        {
+            std::uint64_t bits;
+            std::memcpy(&bits, &value, sizeof(bits));
+            writeUint32(dest, static_cast<std::uint32_t>(bits));
+            writeUint32(dest, static_cast<std::uint32_t>(bits >> 32));
+        }
+
+        int readUint8(const std::uint8_t*& source) noexcept
+        {
+            return *source++;
+        }
+
+        int readUint16(const std::uint8_t*& source) noexcept
+        {
+            const int value = source[0] | (source[1] << 8);
+            source += 2;
+            return value;
+        }
+
+        std::uint32_t readUint32(const std::uint8_t*& source) noexcept
+        {
+            const auto value = static_cast<std::uint32_t>(source[0])
+                             | (static_cast<std::uint32_t>(source[1]) << 8)
+                             | (static_cast<std::uint32_t>(source[2]) << 16)
+                             | (static_cast<std::uint32_t>(source[3]) << 24);
+            source += 4;
+            return value;
+        }
+
+        float readFloat(const std::uint8_t*& source) noexcept
+        {
+            const std::uint32_t bits = readUint32(source);
+            float value;
+            std::memcpy(&value, &bits, sizeof(value));
+            return value;
+        }
+
+        double readDouble(const std::uint8_t*& source) noexcept
+        {
+            const std::uint64_t low = readUint32(source);
+            const std::uint64_t bits = low | (static_cast<std::uint64_t>(readUint32(source)) << 32);
+            double value;
+            std::memcpy(&value, &bits, sizeof(value));
+            return value;
+        }
+
+        // NaN-safe clamp for values read from the blob
+        float clampFloat(float value, float minimum, float maximum, float fallback) noexcept
+        {
+            return std::isnan(value) ? fallback : std::clamp(value, minimum, maximum);
+        }
+
+        void writeTrace(std::uint8_t*& dest, const float* trace) noexcept
+        {
+            for (int i = 0; i < numBins; ++i)
+            {
+                const float dB = clampFloat(trace[i], AnalysisStages::mindB, AnalysisStages::maxdB, AnalysisStages::mindB);
+                writeUint16(dest, static_cast<int>((dB - AnalysisStages::mindB) * traceScale + 0.5f));
+            }
+        }
+    }
+
+    //==============================================================================
+    int getSize(const Traces* traces) noexcept
+    {
+        if (traces == nullptr)
+            return headerSize + settingsSize;
+
+        return headerSize + settingsSize + tracesSize + (traces->average != nullptr ? averageSize : 0);
+    }
+
+    void write(const Settings& settings, const Traces* traces, void* dest) noexcept
+    {
+        auto* position = static_cast<std::uint8_t*>(dest);
+
+        writeUint32(position, magic);
+        writeUint16(position, version);
+        const bool withAverage = traces != nullptr && traces->average != nullptr;
+        writeUint16(position, (traces != nullptr ? hasTraces : 0) | (withAverage ? hasAverage : 0));
+        writeUint16(position, settingsSize);
+
+        const auto& analysis = settings.analysis;
+        writeUint8(position, static_cast<int>(analysis.weighting));
+        writeUint8(position, analysis.octaveFraction);
+        writeFloat(position, analysis.timeSmoothing);
+        writeUint8(position, analysis.peakHoldEnabled ? 1 : 0);
+        writeFloat(position, analysis.peakDecaydBPerSecond);
+        writeUint8(position, analysis.stereoAnalysisEnabled ? 1 : 0);
+        writeUint8(position, settings.lowLatencyMode ? 1 : 0);
+        writeUint8(position, settings.rateAdaptive ? 1 : 0);
+        writeUint8(position, settings.peakMarkersEnabled ? 1 : 0);
+        writeUint8(position, settings.historyDisplay);
+        writeFloat(position, settings.historyWindowSeconds);
+
+        if (traces == nullptr)
+            return;
+
+        writeDouble(position, traces->sampleRate);
+        writeUint16(position, numBins);
+        writeTrace(position, traces->latestFrame);
+        writeTrace(position, traces->smoothed);
+        writeTrace(position, traces->peakHold);
+
+        if (!withAverage)
+            return;
+
+        const auto numFrames = static_cast<std::uint64_t>(std::max<std::int64_t>(0, traces->averageFrames));
+        writeUint32(position, static_cast<std::uint32_t>(numFrames));
+        writeUint32(position, static_cast<std::uint32_t>(numFrames >> 32));
+        writeUint16(position, numBins);
+        writeTrace(position, traces->average);
+    }
+
+    bool read(const void* data, int size, View& view) noexcept
+    {
+        if (data == nullptr || size < headerSize)
+            return false;
+
+        const auto* position = static_cast<const std::uint8_t*>(data);
+        const auto* end = position + size;
+
+        if (readUint32(position) != magic || readUint16(position) != version)
+            return false;
+
+        const int flags = readUint16(position);
+        const int storedSettingsSize = readUint16(position);
+
+        if (storedSettingsSize < settingsSize || end - position < storedSettingsSize)
+            return false;
+
+        // Fields appended by later writers are skipped below
+        const auto* settingsEnd = position + storedSettingsSize;
+
+        view = {};
+        auto& settings = view.settings;
+        auto& analysis = settings.analysis;
+
+        analysis.weighting = static_cast<AnalysisSettings::Weighting>(std::min(readUint8(position), static_cast<int>(AnalysisSettings::Weighting::c)));
+        analysis.octaveFraction = std::min(readUint8(position), 24);
+        analysis.timeSmoothing = clampFloat(readFloat(position), 0.0f, 0.99f, analysis.timeSmoothing);
+        analysis.peakHoldEnabled = readUint8(position) != 0;
+        analysis.peakDecaydBPerSecond = clampFloat(readFloat(position), 0.0f, 120.0f, analysis.peakDecaydBPerSecond);
+        analysis.stereoAnalysisEnabled = readUint8(position) != 0;
+        settings.lowLatencyMode = readUint8(position) != 0;
+        settings.rateAdaptive = readUint8(position) != 0;
+        settings.peakMarkersEnabled = readUint8(position) != 0;
+        settings.historyDisplay = std::min(readUint8(position), 5);
+        settings.historyWindowSeconds = clampFloat(readFloat(position), 0.1f, 3600.0f, settings.historyWindowSeconds);
+
+        position = settingsEnd;
+
+        // Blocks from a build with another FFT size are skipped and truncated
+        // ones dropped; the settings still apply
+        if ((flags & hasTraces) != 0)
+        {
+            if (end - position < 10)
+                return true;
+
+            const double sampleRate = readDouble(position);
+            const int storedBins = readUint16(position);
+            const std::ptrdiff_t blockSize = static_cast<std::ptrdiff_t>(numTraces) * 2 * storedBins;
+
+            if (end - position < blockSize)
+                return true;
+
+            if (storedBins == numBins && sampleRate > 0.0 && sampleRate <= 1.0e6)
+            {
+                view.sampleRate = sampleRate;
+                view.latestFrame = position;
+                view.smoothed = position + 2 * numBins;
+                view.peakHold = position + 4 * numBins;
+            }
+
+            position += blockSize;
+        }
+
+        if ((flags & hasAverage) != 0 && end - position >= 10)
+        {
+            const std::uint64_t low = readUint32(position);
+            const auto numFrames = static_cast<std::int64_t>(low | (static_cast<std::uint64_t>(readUint32(position)) << 32));
+
+            if (readUint16(position) == numBins && end - position >= 2 * numBins && numFrames > 0)
+            {
+                view.average = position;
+                view.averageFrames = numFrames;
+            }
+        }
+
+        return true;
+    }
+
+    void decodeTrace(const std::uint8_t* encoded, float* dest) noexcept
+    {
+        for (int i = 0; i < numBins; ++i)
+            dest[i] = AnalysisStages::mindB + static_cast<float>(readUint16(encoded)) / traceScale;
+    }
+}
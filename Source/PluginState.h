@@ -0,0 +1,102 @@
+#pragma once
+
+#include <cstdint>
+#include "AnalysisStages.h"
+#include "SpectrumSnapshot.h"
+
+//==============================================================================
+// Saved plugin state: a compact, versioned little-endian blob that the host
+// stores with the project.
+//
+//   uint32 magic, uint16 version, uint16 flags, uint16 settingsSize,
+//   settings (settingsSize bytes),
+//   if flags has hasTraces:
+//     float64 sampleRate, uint16 numBins,
+//     latest frame, smoothed spectrum, peak hold: numBins uint16 each
+//   if flags has hasAverage:
+//     int64 numFrames, uint16 numBins,
+//     average since reset over numFrames frames: numBins uint16
+//
+// Trace values are dB mapped linearly from mindB..maxdB onto 0..65535. The
+// windowed history traces (max, min, average) are not saved; they refill
+// within their window.
+//
+// Fields are only ever appended to the settings block, so a reader takes the
+// fields it knows and skips the rest; the version changes only when the
+// layout stops being compatible. Reading validates the blob and returns a View
+// that points into it: nothing is copied or allocated, and each trace is
+// decoded straight into its destination.
+namespace PluginState
+{
+    //==============================================================================
+    static constexpr std::uint32_t magic = 0x5a415053;  // "SPAZ"
+    static constexpr int version = 1;
+
+    enum Flags : std::uint16_t
+    {
+        hasTraces = 1,
+        hasAverage = 2
+    };
+
+    static constexpr int headerSize = 10;
+    static constexpr int settingsSize = 20;
+    static constexpr int numTraces = 3;
+    static constexpr int numBins = SpectrumSnapshot::numBins;
+    static constexpr int tracesSize = 10 + numTraces * 2 * numBins;
+    static constexpr int averageSize = 10 + 2 * numBins;
+
+    //==============================================================================
+    // Everything the user can set, whether it lives in the processor, the
+    // analysis engine or the display
+    struct Settings
+    {
+        AnalysisSettings analysis;
+        bool lowLatencyMode = false;
+        bool rateAdaptive = true;
+        bool peakMarkersEnabled = true;
+        int historyDisplay = 0;  // SpectrumAnalyzerComponent::HistoryDisplay
+        float historyWindowSeconds = 10.0f;
+    };
+
+    // Traces to save, numBins values each. average (the history's average
+    // since reset) is optional.
+    struct Traces
+    {
+        double sampleRate = 0.0;
+        const float* latestFrame = nullptr;
+        const float* smoothed = nullptr;
+        const float* peakHold = nullptr;
+        const float* average = nullptr;
+        std::int64_t averageFrames = 0;
+    };
+
+    // A validated blob. The trace pointers refer to the encoded data and are
+    // only valid while it is; null when the blob has no (usable) traces.
+    struct View
+    {
+        Settings settings;
+        double sampleRate = 0.0;
+        const std::uint8_t* latestFrame = nullptr;
+        const std::uint8_t* smoothed = nullptr;
+        const std::uint8_t* peakHold = nullptr;
+        const std::uint8_t* average = nullptr;
+        std::int64_t averageFrames = 0;
+
+        bool hasTraces() const noexcept { return latestFrame != nullptr; }
+        bool hasAverage() const noexcept { return average != nullptr; }
+    };
+
+    //==============================================================================
+    // Bytes needed by write()
+    int getSize(const Traces* traces) noexcept;
+
+    // Writes getSize(traces) bytes to dest; traces may be null
+    void write(const Settings& settings, const Traces* traces, void* dest) noexcept;
+
+    // Returns false if the data is not a state blob this version can read.
+    // Out-of-range settings are clamped.
+    bool read(const void* data, int size, View& view) noexcept;
+
+    // Decodes one trace of a View into numBins dB values
+    void decodeTrace(const std::uint8_t* encoded, float* dest) noexcept;
+}
@@ -0,0 +1,46 @@
+#include "RealFFT.h"
+#include <cmath>
+
+//==============================================================================
+RealFFT::RealFFT(int order)
+    : size(1 << order),
+      halfFFT(order - 1),
+      twiddles(static_cast<size_t>(size / 2 + 1)),
+      packed(static_cast<size_t>(size / 2))
+{
+    for (int k = 0; k <= size / 2; ++k)
+    {
+        const double angle = -2.0 * juce::MathConstants<double>::pi * k / size;
+
+        // Fold the -j/2 of the odd-sample spectrum into the twiddle
+        twiddles[static_cast<size_t>(k)] = Complex(static_cast<float>(0.5 * std::sin(angle)),
+                                                   static_cast<float>(-0.5 * std::cos(angle)));
+    }
+}
+
+//==============================================================================
+RealFFT::Complex RealFFT::splitBin(int k) const noexcept
+{
+    const int half = size / 2;
+    const auto& zk = packed[static_cast<size_t>(k == half ? 0 : k)];
+    const auto zn = std::conj(packed[static_cast<size_t>(k == 0 ? 0 : half - k)]);
+
+    // X[k] = (Z[k] + Z*[N/2-k]) / 2 - j/2 W^k (Z[k] - Z*[N/2-k])
+    return 0.5f * (zk + zn) + twiddles[static_cast<size_t>(k)] * (zk - zn);
+}
+
+void RealFFT::performForward(const float* input, Complex* spectrum) noexcept
+{
+    halfFFT.perform(reinterpret_cast<const Complex*>(input), packed.data(), false);
+
+    for (int k = 0; k <= size / 2; ++k)
+        spectrum[k] = splitBin(k);
+}
+
+void RealFFT::performMagnitudes(const float* input, float* magnitudes) noexcept
+{
+    halfFFT.perform(reinterpret_cast<const Complex*>(input), packed.data(), false);
+
+    for (int k = 0; k <= size / 2; ++k)
+        magnitudes[k] = std::abs(splitBin(k));
+}
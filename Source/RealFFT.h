@@ -0,0 +1,41 @@
+#pragma once
+
+#include <juce_dsp/juce_dsp.h>
+#include <vector>
+
+//==============================================================================
+// Forward FFT of a real signal. The N real samples are read in place as N/2
+// complex values (even samples real, odd samples imaginary), transformed with
+// an N/2-point complex FFT, then split into the N/2 + 1 non-negative frequency
+// bins with a precomputed twiddle pass. The input buffer is only N floats and
+// needs no zero padding.
+class RealFFT
+{
+public:
+    //==============================================================================
+    using Complex = juce::dsp::Complex<float>;
+
+    explicit RealFFT(int order);
+
+    int getSize() const noexcept { return size; }
+    int getNumBins() const noexcept { return size / 2 + 1; }
+
+    //==============================================================================
+    // input: getSize() real samples, spectrum: getNumBins() unnormalised bins
+    void performForward(const float* input, Complex* spectrum) noexcept;
+
+    // input: getSize() real samples, magnitudes: getNumBins() unnormalised values
+    void performMagnitudes(const float* input, float* magnitudes) noexcept;
+
+private:
+    //==============================================================================
+    // Bin k of the real transform from bins k and N/2 - k of the packed transform
+    Complex splitBin(int k) const noexcept;
+
+    int size;
+    juce::dsp::FFT halfFFT;
+    std::vector<Complex> twiddles;  // -j/2 * exp(-2 pi j k / N), k in [0, N/2]
+    std::vector<Complex> packed;    // Output of the N/2-point transform
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(RealFFT)
+};
@@ -0,0 +1,33 @@
+#include "SnapshotPool.h"
+#include <bit>
+
+static_assert(SnapshotPool::capacity <= 32, "Ownership mask is a 32-bit word");
+
+//==============================================================================
+SnapshotPool::SnapshotPool()
+    : buffers(static_cast<size_t>(capacity))
+{
+}
+
+int SnapshotPool::acquire() noexcept
+{
+    if (freeMask == 0)
+        return -1;
+
+    const int index = std::countr_zero(freeMask);
+    freeMask &= ~(1u << index);
+    return index;
+}
+
+void SnapshotPool::release(int index) noexcept
+{
+    jassert(index >= 0 && index < capacity);
+    jassert((freeMask & (1u << index)) == 0);
+
+    freeMask |= 1u << index;
+}
+
+int SnapshotPool::getNumFree() const noexcept
+{
+    return std::popcount(freeMask);
+}
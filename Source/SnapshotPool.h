@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "SpectrumSnapshot.h"
+
+//==============================================================================
+// Fixed set of preallocated snapshot buffers for Freeze and the reference
+// overlays. Ownership is a bit per buffer, so claiming and returning a buffer
+// never allocates. Message thread only, like the component that owns it.
+class SnapshotPool
+{
+public:
+    //==============================================================================
+    static constexpr int capacity = 8;
+
+    SnapshotPool();
+
+    // Claims a free buffer; returns -1 when every buffer is owned
+    int acquire() noexcept;
+
+    // Gives a buffer back to the pool; only its owner may call this
+    void release(int index) noexcept;
+
+    // Access for the current owner of the buffer
+    SpectrumSnapshot& get(int index) noexcept { return buffers[static_cast<size_t>(index)]; }
+    const SpectrumSnapshot& get(int index) const noexcept { return buffers[static_cast<size_t>(index)]; }
+
+    int getNumFree() const noexcept;
+
+private:
+    //==============================================================================
+    static constexpr uint32_t allFree = (1u << capacity) - 1u;
+
+    std::vector<SpectrumSnapshot> buffers;
+    uint32_t freeMask = allFree;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SnapshotPool)
+};
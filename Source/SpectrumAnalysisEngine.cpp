@@ -0,0 +1,170 @@
+#include "SpectrumAnalysisEngine.h"
+
+//==============================================================================
+SpectrumAnalysisEngine::SpectrumAnalysisEngine()
+{
+    snapshot.magnitude.fill(AnalysisStages::mindB);
+    peakHold.fill(AnalysisStages::mindB);
+    frameData.fill(AnalysisStages::mindB);
+    restoredAverage.fill(AnalysisStages::mindB);
+    bins.fill(0.0f);
+
+    // Stages with per-bin state write straight into the published arrays
+    pipeline.get<AnalysisStages::Tap>().setDestination(frameData.data());
+    pipeline.get<AnalysisStages::TimeSmoothing>().setState(snapshot.magnitude.data());
+    pipeline.get<AnalysisStages::PeakHold>().setState(peakHold.data());
+
+    pipeline.configure(settings);
+}
+
+//==============================================================================
+void SpectrumAnalysisEngine::setSettings(const AnalysisSettings& newSettings) noexcept
+{
+    if (settings.peakHoldEnabled && !newSettings.peakHoldEnabled)
+        resetPeakHold();
+
+    settings = newSettings;
+    pipeline.configure(settings);
+}
+
+void SpectrumAnalysisEngine::setHistoryEnabled(bool enabled) noexcept
+{
+    // Start a fresh history whenever the traces are switched on
+    if (enabled && !historyEnabled)
+        resetHistory();
+
+    historyEnabled = enabled;
+}
+
+void SpectrumAnalysisEngine::resetHistory() noexcept
+{
+    history.reset();
+    pendingAverageFrames = 0;
+}
+
+void SpectrumAnalysisEngine::setHistoryWindowSeconds(double seconds) noexcept
+{
+    historyWindowSeconds = juce::jmax(0.1, seconds);
+    historyFrameRate = 0.0;  // Re-prepare on the next frame
+}
+
+//==============================================================================
+void SpectrumAnalysisEngine::prepareIfNeeded(double sampleRate, int hopSize)
+{
+    if (sampleRate != preparedSampleRate)
+    {
+        pipeline.prepare({ sampleRate, fftSize, numBins });
+        pipeline.configure(settings);
+        preparedSampleRate = sampleRate;
+    }
+
+    // Allocation only happens here, when the window or frame rate changes
+    const double frameRate = sampleRate / static_cast<double>(juce::jmax(1, hopSize));
+
+    if (historyEnabled && (frameRate != historyFrameRate || history.getNumBins() != numBins))
+    {
+        history.prepare(numBins, frameRate, historyWindowSeconds);
+        historyFrameRate = frameRate;
+    }
+}
+
+void SpectrumAnalysisEngine::processFrame(const float* left, const float* right, bool isStereo,
+                                          double sampleRate, int hopSize, juce::int64 timestamp)
+{
+    prepareIfNeeded(sampleRate, hopSize);
+
+    snapshot.sampleRate = sampleRate;
+    snapshot.timestamp = timestamp;
+    snapshot.isStereo = isStereo;
+
+    AnalysisFrame frame;
+    frame.left = left;
+    frame.right = isStereo ? right : left;
+    frame.isStereo = isStereo;
+    frame.numSamples = fftSize;
+    frame.bins = bins.data();
+    frame.numBins = numBins;
+    frame.snapshot = &snapshot;
+
+    pipeline.process(frame);
+
+    // Refine peaks on the unsmoothed frame so readings don't lag moving tones
+    peakDetector.process(frameData.data(), numBins, sampleRate, fftSize);
+
+    // History traces follow the unsmoothed frames too, so max/min are true extremes
+    if (historyEnabled)
+    {
+        // A restored average waits until prepare() has sized (and cleared) the history
+        if (pendingAverageFrames > 0)
+        {
+            history.restoreInfiniteAverage(restoredAverage.data(), pendingAverageFrames);
+            pendingAverageFrames = 0;
+        }
+
+        history.addFrame(frameData.data());
+    }
+
+    ++numFramesAnalysed;
+}
+
+bool SpectrumAnalysisEngine::decayPeakHold(float decaydB) noexcept
+{
+    bool anyDecayed = false;
+
+    for (auto& peak : peakHold)
+    {
+        if (peak > AnalysisStages::mindB + 1.0f)  // Only decay if above noise floor
+        {
+            peak = juce::jmax(AnalysisStages::mindB, peak - decaydB);
+            anyDecayed = true;
+        }
+    }
+
+    return anyDecayed;
+}
+
+void SpectrumAnalysisEngine::resetPeakHold() noexcept
+{
+    peakHold.fill(AnalysisStages::mindB);
+}
+
+void SpectrumAnalysisEngine::restoreTraces(const PluginState::View& view) noexcept
+{
+    pendingAverageFrames = 0;
+
+    if (!view.hasTraces())
+        return;
+
+    // Decoded straight into the arrays the pipeline stages update in place
+    PluginState::decodeTrace(view.latestFrame, frameData.data());
+    PluginState::decodeTrace(view.smoothed, snapshot.magnitude.data());
+    PluginState::decodeTrace(view.peakHold, peakHold.data());
+
+    snapshot.sampleRate = view.sampleRate;
+    peakDetector.process(frameData.data(), numBins, view.sampleRate, fftSize);
+    tracesRestored = true;
+
+    if (view.hasAverage() && historyEnabled)
+    {
+        PluginState::decodeTrace(view.average, restoredAverage.data());
+        pendingAverageFrames = view.averageFrames;
+    }
+}
+
+const float* SpectrumAnalysisEngine::getInfiniteAverage(juce::int64& numFrames) const noexcept
+{
+    if (pendingAverageFrames > 0)
+    {
+        numFrames = pendingAverageFrames;
+        return restoredAverage.data();
+    }
+
+    if (historyEnabled && history.hasData())
+    {
+        numFrames = history.getInfiniteCount();
+        return history.getTrace(SpectrumHistory::Trace::infiniteAverage);
+    }
+
+    numFrames = 0;
+    return nullptr;
+}
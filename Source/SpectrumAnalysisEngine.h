@@ -0,0 +1,110 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <array>
+#include "AnalysisPipeline.h"
+#include "AnalysisStages.h"
+#include "PeakDetector.h"
+#include "PluginState.h"
+#include "SpectrumHistory.h"
+#include "SpectrumSnapshot.h"
+
+//==============================================================================
+// Turns windowed frames into everything the display shows: the smoothed
+// spectrum and stereo measurements (snapshot), peak hold, refined peaks and
+// history traces. Independent of the processor and the GUI, so the plugin and
+// offline tools run the same chain; not thread-safe, call from one thread.
+class SpectrumAnalysisEngine
+{
+public:
+    //==============================================================================
+    static constexpr int fftSize = SpectrumSnapshot::fftSize;
+    static constexpr int numBins = SpectrumSnapshot::numBins;
+
+    // The tap sits before octave smoothing: peaks and history read the
+    // weighted dB of the raw frame, only the display is smoothed
+    using Pipeline = AnalysisPipeline<AnalysisStages::Transform,
+                                      AnalysisStages::Normalise,
+                                      AnalysisStages::Weighting,
+                                      AnalysisStages::Decibels,
+                                      AnalysisStages::Tap,
+                                      AnalysisStages::OctaveSmoothing,
+                                      AnalysisStages::TimeSmoothing,
+                                      AnalysisStages::PeakHold>;
+
+    // Transform plus one fused loop over the bins; octave smoothing, when on,
+    // splits that loop around its own two passes
+    static_assert(Pipeline::getNumPasses() == 2);
+    static_assert(Pipeline::getMaxNumPasses() == 5);
+
+    SpectrumAnalysisEngine();
+
+    //==============================================================================
+    void setSettings(const AnalysisSettings& newSettings) noexcept;
+    const AnalysisSettings& getSettings() const noexcept { return settings; }
+
+    // History runs only while enabled; changing the window re-prepares it,
+    // which restarts the windowed traces but keeps the average since reset
+    void setHistoryEnabled(bool enabled) noexcept;
+    bool isHistoryEnabled() const noexcept { return historyEnabled; }
+    void setHistoryWindowSeconds(double seconds) noexcept;
+    double getHistoryWindowSeconds() const noexcept { return historyWindowSeconds; }
+    void resetHistory() noexcept;
+
+    //==============================================================================
+    // Analyses one windowed frame per channel (fftSize samples each). May
+    // allocate only when the sample rate or history frame rate changes.
+    void processFrame(const float* left, const float* right, bool isStereo,
+                      double sampleRate, int hopSize, juce::int64 timestamp);
+
+    // Lowers the peak hold by decaydB (once per analysis tick); returns true if anything moved
+    bool decayPeakHold(float decaydB) noexcept;
+    void resetPeakHold() noexcept;
+
+    // Warm start from saved state: the latest frame, smoothed spectrum and peak
+    // hold continue from the view's traces (if it has any), and the history's
+    // average since reset from its saved average once the history is
+    // prepared. No allocation.
+    void restoreTraces(const PluginState::View& view) noexcept;
+
+    // True once there is a spectrum worth saving (analysed or restored)
+    bool hasTraces() const noexcept { return numFramesAnalysed > 0 || tracesRestored; }
+
+    // The average since reset worth saving (measured or restored but not yet
+    // applied) and the number of frames it covers; nullptr and 0 if none
+    const float* getInfiniteAverage(juce::int64& numFrames) const noexcept;
+
+    //==============================================================================
+    const SpectrumSnapshot& getSnapshot() const noexcept { return snapshot; }
+    const std::array<float, numBins>& getPeakHold() const noexcept { return peakHold; }
+    const std::array<float, numBins>& getFrameData() const noexcept { return frameData; }
+    const PeakDetector& getPeakDetector() const noexcept { return peakDetector; }
+    const SpectrumHistory& getHistory() const noexcept { return history; }
+    juce::int64 getNumFramesAnalysed() const noexcept { return numFramesAnalysed; }
+
+private:
+    //==============================================================================
+    void prepareIfNeeded(double sampleRate, int hopSize);
+
+    Pipeline pipeline;
+    AnalysisSettings settings;
+
+    SpectrumSnapshot snapshot;
+    std::array<float, numBins> peakHold;
+    std::array<float, numBins> frameData;  // Unsmoothed dB of the latest frame
+    std::array<float, numBins + 1> bins;   // Pipeline working buffer, DC to Nyquist
+
+    PeakDetector peakDetector;
+    SpectrumHistory history;
+    bool historyEnabled = false;
+    double historyWindowSeconds = 10.0;
+    double historyFrameRate = 0.0;  // Frame rate the history was prepared for
+    std::array<float, numBins> restoredAverage;
+    juce::int64 pendingAverageFrames = 0;  // Restored average waiting for the history
+
+    double preparedSampleRate = 0.0;
+    juce::int64 numFramesAnalysed = 0;
+    bool tracesRestored = false;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SpectrumAnalysisEngine)
+};
@@ -1,144 +1,400 @@
 #include "SpectrumAnalyzerComponent.h"
-#include "PluginProcessor.h"
 #include <cmath>
 
+static_assert(SpectrumAnalyzerComponent::fftSize == SpectrumSnapshot::fftSize,
+              "Display and analysis must agree on the FFT size");
+
 //==============================================================================
-SpectrumAnalyzerComponent::SpectrumAnalyzerComponent(SpectrumAnalyzerAudioProcessor& processor)
-    : audioProcessor(processor)
+SpectrumAnalyzerComponent::SpectrumAnalyzerComponent(SpectrumDisplaySource& displaySource)
+    : source(displaySource),
+      analysisEngine(displaySource.getDisplayedEngine())
 {
-    spectrumData.fill(-100.0f);
-    peakData.fill(-100.0f);
+    // The engine and the display modes live in the source and outlive the
+    // editor, so the spectrum shows immediately without converging again
+    if (analysisEngine != nullptr)
+    {
+        const juce::ScopedLock sl(source.getEngineLock());
+        currentSampleRate = analysisEngine->getSnapshot().sampleRate;
+        analysisEngine->setHistoryEnabled(getHistoryDisplay() != HistoryDisplay::none);
+    }
     
-    // Start timer at 60fps
-    startTimerHz(60);
+    source.addChangeListener(this);
+    source.addDisplayListener(this);
 }
 
 SpectrumAnalyzerComponent::~SpectrumAnalyzerComponent()
 {
-    stopTimer();
+    source.removeDisplayListener(this);
+    source.removeChangeListener(this);
 }
 
 //==============================================================================
 void SpectrumAnalyzerComponent::paint(juce::Graphics& g)
 {
+    // The engine holds still while it is drawn
+    const juce::ScopedLock sl(source.getEngineLock());
+    
     drawBackground(g);
     drawGrid(g);
     
-    if (peakHoldEnabled)
+    // Remote display: the received columns are all there is
+    if (analysisEngine == nullptr)
+    {
+        drawSpectrum(g);
+        return;
+    }
+    
+    if (isPeakHoldEnabled())
     {
         drawPeakHold(g);
     }
     
+    if (getHistoryDisplay() != HistoryDisplay::none)
+    {
+        drawHistoryTraces(g);
+    }
+    
+    updateColumnLayoutIfNeeded();
+    
+    if (numReferences > 0)
+    {
+        drawReferences(g);
+    }
+    
     drawSpectrum(g);
+    
+    if (differenceEnabled && numReferences > 0 && !remoteDisplay)
+    {
+        drawDifference(g);
+    }
+    
+    if (isStereoAnalysisEnabled())
+    {
+        drawStereoAnalysis(g);
+    }
+    
+    if (arePeakMarkersEnabled())
+    {
+        drawPeakMarkers(g);
+    }
+    
+    drawLatencyReadout(g);
+    
+    if (isFrozen())
+    {
+        g.setFont(juce::Font(12.0f, juce::Font::bold));
+        g.setColour(markerColor);
+        g.drawText("FROZEN", getLocalBounds().removeFromTop(18).reduced(60, 0), juce::Justification::centredLeft);
+    }
+    
+    // The newest frame is now painted; the compositor still has to show it
+    if (frameAwaitingPaint)
+    {
+        const auto elapsed = juce::Time::getHighResolutionTicks() - pendingFrameTimestamp;
+        paintLatency.addSample(juce::Time::highResolutionTicksToSeconds(elapsed) * 1000.0);
+        frameAwaitingPaint = false;
+    }
 }
 
 void SpectrumAnalyzerComponent::resized()
 {
-    // No child components to layout
+    // No child components to layout; column caches follow the new width
+    updateColumnLayoutIfNeeded();
 }
 
 //==============================================================================
+void SpectrumAnalyzerComponent::setAnalysisSettings(const AnalysisSettings& settings)
+{
+    if (analysisEngine != nullptr)
+    {
+        const juce::ScopedLock sl(source.getEngineLock());
+        analysisEngine->setSettings(settings);
+    }
+    
+    repaint();
+}
+
+AnalysisSettings SpectrumAnalyzerComponent::getAnalysisSettings() const
+{
+    if (analysisEngine == nullptr)
+        return {};
+    
+    const juce::ScopedLock sl(source.getEngineLock());
+    return analysisEngine->getSettings();
+}
+
 void SpectrumAnalyzerComponent::setPeakHoldEnabled(bool enabled)
 {
-    peakHoldEnabled = enabled;
+    auto settings = getAnalysisSettings();
+    settings.peakHoldEnabled = enabled;
+    setAnalysisSettings(settings);
+}
+
+void SpectrumAnalyzerComponent::setPeakMarkersEnabled(bool enabled)
+{
+    source.setPeakMarkersEnabled(enabled);
+    repaint();
+}
+
+bool SpectrumAnalyzerComponent::arePeakMarkersEnabled() const
+{
+    return source.arePeakMarkersEnabled();
+}
+
+void SpectrumAnalyzerComponent::setLowLatencyMode(bool enabled)
+{
+    source.setLowLatencyMode(enabled);
+    resetLatencyStats();
+}
+
+bool SpectrumAnalyzerComponent::isLowLatencyMode() const
+{
+    return source.isLowLatencyMode();
+}
+
+void SpectrumAnalyzerComponent::resetLatencyStats()
+{
+    analysisLatency.reset();
+    paintLatency.reset();
+    frameAwaitingPaint = false;
+}
+
+void SpectrumAnalyzerComponent::setHistoryDisplay(HistoryDisplay display)
+{
+    // Start a fresh history whenever the traces are switched on or changed
+    if (display != getHistoryDisplay())
+        resetHistory();
     
-    if (!enabled)
+    source.setHistoryDisplay(static_cast<int>(display));
+    
+    if (analysisEngine != nullptr)
     {
-        resetPeakData();
+        const juce::ScopedLock sl(source.getEngineLock());
+        analysisEngine->setHistoryEnabled(display != HistoryDisplay::none);
     }
     
     repaint();
 }
 
-void SpectrumAnalyzerComponent::resetPeakData()
+SpectrumAnalyzerComponent::HistoryDisplay SpectrumAnalyzerComponent::getHistoryDisplay() const
 {
-    peakData.fill(-100.0f);
+    return static_cast<HistoryDisplay>(source.getHistoryDisplay());
 }
 
-//==============================================================================
-void SpectrumAnalyzerComponent::timerCallback()
+void SpectrumAnalyzerComponent::setHistoryWindowSeconds(double seconds)
 {
-    if (audioProcessor.isNextFFTBlockReady())
+    if (analysisEngine != nullptr)
     {
-        updateSpectrumData();
-        audioProcessor.resetFFTBlockReady();
-        repaint();
+        const juce::ScopedLock sl(source.getEngineLock());
+        analysisEngine->setHistoryWindowSeconds(seconds);
     }
-    else
+    
+    repaint();
+}
+
+double SpectrumAnalyzerComponent::getHistoryWindowSeconds() const
+{
+    if (analysisEngine == nullptr)
+        return 0.0;
+    
+    const juce::ScopedLock sl(source.getEngineLock());
+    return analysisEngine->getHistoryWindowSeconds();
+}
+
+void SpectrumAnalyzerComponent::resetHistory()
+{
+    if (analysisEngine != nullptr)
     {
-        // Still update peak decay even without new data
-        if (peakHoldEnabled)
-        {
-            bool needsRepaint = false;
-            for (size_t i = 0; i < peakData.size(); ++i)
-            {
-                if (peakData[i] > mindB + 1.0f)  // Only decay if above noise floor
-                {
-                    peakData[i] -= 0.3f;
-                    if (peakData[i] < mindB)
-                        peakData[i] = mindB;
-                    needsRepaint = true;
-                }
-            }
-            if (needsRepaint)
-            {
-                repaint();
-            }
-        }
+        const juce::ScopedLock sl(source.getEngineLock());
+        analysisEngine->resetHistory();
     }
 }
 
-void SpectrumAnalyzerComponent::updateSpectrumData()
+void SpectrumAnalyzerComponent::setStereoAnalysisEnabled(bool enabled)
 {
-    // Get sample rate from processor
-    currentSampleRate = audioProcessor.getSampleRate();
-    if (currentSampleRate <= 0)
-        currentSampleRate = 44100.0;
-    
-    // Get FFT data and perform FFT
-    auto& fftData = audioProcessor.getFFTDataForWriting();
-    audioProcessor.getFFT().performFrequencyOnlyForwardTransform(fftData.data());
+    auto settings = getAnalysisSettings();
+    settings.stereoAnalysisEnabled = enabled;
+    setAnalysisSettings(settings);
+}
+
+void SpectrumAnalyzerComponent::setFrozen(bool shouldBeFrozen)
+{
+    if (shouldBeFrozen == isFrozen() || analysisEngine == nullptr)
+        return;
     
-    const int numBins = fftSize / 2;
-    const float smoothingFactor = 0.7f;
-    const float noiseFloor = -96.0f;  // Threshold below which we ignore
+    const juce::ScopedLock sl(source.getEngineLock());
     
-    for (int i = 0; i < numBins; ++i)
+    if (shouldBeFrozen)
     {
-        // Calculate magnitude
-        float magnitude = fftData[i];
+        // References leave one buffer free, so this only fails if that changes
+        const int slot = snapshotPool.acquire();
+        jassert(slot >= 0);
         
-        // Normalize by FFT size
-        magnitude /= static_cast<float>(fftSize);
+        if (slot < 0)
+            return;
         
-        // Convert to dB
-        float dB = magnitude > 0.0f 
-                   ? 20.0f * std::log10(magnitude) 
-                   : mindB;
+        snapshotPool.get(slot) = analysisEngine->getSnapshot();
+        frozenPeaks = analysisEngine->getPeakDetector();
+        frozenSlot = slot;
+    }
+    else
+    {
+        snapshotPool.release(frozenSlot);
+        frozenSlot = -1;
         
-        // Clamp to range
-        dB = juce::jlimit(mindB, maxdB, dB);
+        // Catch up with frames analysed while frozen
+        currentSampleRate = analysisEngine->getSnapshot().sampleRate;
+    }
+    
+    repaint();
+}
+
+void SpectrumAnalyzerComponent::captureReference()
+{
+    // The local snapshot is not what a remote display shows
+    if (remoteDisplay || analysisEngine == nullptr)
+        return;
+    
+    const juce::ScopedLock sl(source.getEngineLock());
+    
+    // Full: recycle the oldest reference
+    if (numReferences == maxReferences)
+    {
+        snapshotPool.release(referenceSlots[0]);
+        std::move(referenceSlots.begin() + 1, referenceSlots.begin() + numReferences, referenceSlots.begin());
+        --numReferences;
+    }
+    
+    const int slot = snapshotPool.acquire();
+    
+    if (slot < 0)
+        return;
+    
+    // Plain copy into a preallocated buffer, then reduce once for drawing
+    snapshotPool.get(slot) = getSnapshot();
+    referenceSlots[static_cast<size_t>(numReferences++)] = slot;
+    reduceReference(slot);
+    repaint();
+}
+
+void SpectrumAnalyzerComponent::clearReferences()
+{
+    for (int i = 0; i < numReferences; ++i)
+        snapshotPool.release(referenceSlots[static_cast<size_t>(i)]);
+    
+    numReferences = 0;
+    repaint();
+}
+
+const SpectrumSnapshot& SpectrumAnalyzerComponent::getReference(int index) const
+{
+    jassert(index >= 0 && index < numReferences);
+    return snapshotPool.get(referenceSlots[static_cast<size_t>(index)]);
+}
+
+void SpectrumAnalyzerComponent::setDifferenceEnabled(bool enabled)
+{
+    differenceEnabled = enabled;
+    repaint();
+}
+
+void SpectrumAnalyzerComponent::setRemoteColumns(const float* columns, int numColumns,
+                                                 int numValidColumns, double sampleRate)
+{
+    remoteColumns.assign(columns, columns + numColumns);
+    remoteValidColumns = juce::jlimit(0, numColumns, numValidColumns);
+    remoteDisplay = true;
+    
+    if (sampleRate > 0)
+        currentSampleRate = sampleRate;
+    
+    repaint();
+}
+
+void SpectrumAnalyzerComponent::updateColumnLayoutIfNeeded()
+{
+    const int numColumns = juce::jmax(0, getWidth());
+    
+    if (columnReducer.isPreparedFor(numColumns, currentSampleRate))
+        return;
+    
+    columnReducer.prepare(numColumns, fftSize / 2, currentSampleRate, fftSize, minFreq, maxFreq);
+    
+    // Size the reference reducer and every slot's cache now so capturing
+    // never allocates; re-preparing for another rate reuses this capacity
+    referenceReducer.prepare(numColumns, fftSize / 2, currentSampleRate, fftSize, minFreq, maxFreq);
+    liveColumns.resize(static_cast<size_t>(numColumns));
+    
+    for (auto& columns : referenceColumns)
+        columns.resize(static_cast<size_t>(numColumns));
+    
+    for (int i = 0; i < numReferences; ++i)
+        reduceReference(referenceSlots[static_cast<size_t>(i)]);
+}
+
+void SpectrumAnalyzerComponent::reduceReference(int slot)
+{
+    const auto& reference = snapshotPool.get(slot);
+    auto& columns = referenceColumns[static_cast<size_t>(slot)];
+    const int numColumns = columnReducer.getNumColumns();
+    jassert(static_cast<int>(columns.size()) >= numColumns);
+    
+    const ColumnReducer* reducer = &columnReducer;
+    
+    // Captured at another rate: relayout within the capacity reserved above
+    if (reference.sampleRate != currentSampleRate)
+    {
+        if (!referenceReducer.isPreparedFor(numColumns, reference.sampleRate))
+            referenceReducer.prepare(numColumns, fftSize / 2, reference.sampleRate, fftSize, minFreq, maxFreq);
         
-        // Apply smoothing for less jittery display
-        spectrumData[i] = spectrumData[i] * smoothingFactor + dB * (1.0f - smoothingFactor);
+        reducer = &referenceReducer;
+    }
+    
+    reducer->reduce(reference.magnitude.data(), columns.data());
+    referenceValidColumns[static_cast<size_t>(slot)] = reducer->getNumValidColumns();
+}
+
+//==============================================================================
+void SpectrumAnalyzerComponent::analysisUpdated(bool newFrame)
+{
+    // Frozen or not, the processor has analysed the frame: history, peak hold
+    // and the stream carry on, only the drawn copy holds still
+    if (analysisEngine == nullptr)
+        return;
+    
+    const juce::ScopedLock sl(source.getEngineLock());
+    
+    if (!newFrame)
+    {
+        // Peak hold decayed
+        if (!isFrozen())
+            repaint();
         
-        // Update peak data
-        if (peakHoldEnabled)
-        {
-            // Only update peak if signal is above noise floor
-            if (spectrumData[i] > noiseFloor && spectrumData[i] > peakData[i])
-            {
-                peakData[i] = spectrumData[i];
-            }
-            else if (peakData[i] > mindB)
-            {
-                // Decay peak slowly (subtract dB, since this is a dB scale)
-                peakData[i] -= 0.3f;  // About 0.3 dB per frame at 60fps = ~18dB/sec
-                if (peakData[i] < mindB)
-                    peakData[i] = mindB;
-            }
-        }
+        return;
     }
+    
+    const auto& snapshot = analysisEngine->getSnapshot();
+    const auto elapsed = juce::Time::getHighResolutionTicks() - snapshot.timestamp;
+    analysisLatency.addSample(juce::Time::highResolutionTicksToSeconds(elapsed) * 1000.0);
+    
+    if (isFrozen())
+        return;
+    
+    // Bins follow the rate the frame was analysed at, which is below the host
+    // rate when the processor decimates
+    if (snapshot.sampleRate > 0)
+        currentSampleRate = snapshot.sampleRate;
+    
+    pendingFrameTimestamp = snapshot.timestamp;
+    frameAwaitingPaint = true;
+    repaint();
+}
+
+void SpectrumAnalyzerComponent::changeListenerCallback(juce::ChangeBroadcaster*)
+{
+    // The host restored state: follow the processor's modes and redraw
+    resetLatencyStats();
+    repaint();
 }
 
 //==============================================================================
@@ -261,18 +517,28 @@ void SpectrumAnalyzerComponent::drawSpectrum(juce::Graphics& g)
     bool pathStarted = false;
     float lastX = 0.0f;
     
-    const int numBins = fftSize / 2;
+    // One vertex per pixel column: max of the bins it covers
+    const float* columns = liveColumns.data();
+    int numColumns = 0;
+    float columnScale = 1.0f;
     
-    for (int i = 1; i < numBins; ++i)
+    if (remoteDisplay)
     {
-        const float freq = binToFrequency(i);
-        
-        // Skip frequencies outside our display range
-        if (freq < minFreq || freq > maxFreq)
-            continue;
-        
-        const float x = frequencyToX(freq);
-        const float y = magnitudeToY(spectrumData[i]);
+        // Reduced by the server for the width we requested; stretch until a resize catches up
+        columns = remoteColumns.data();
+        numColumns = remoteValidColumns;
+        columnScale = width / static_cast<float>(juce::jmax(1, static_cast<int>(remoteColumns.size())));
+    }
+    else if (analysisEngine != nullptr)
+    {
+        columnReducer.reduce(getSnapshot().magnitude.data(), liveColumns.data());
+        numColumns = columnReducer.getNumValidColumns();
+    }
+    
+    for (int c = 0; c < numColumns; ++c)
+    {
+        const float x = ColumnReducer::getColumnX(c) * columnScale;
+        const float y = magnitudeToY(columns[c]);
         
         if (!pathStarted)
         {
@@ -332,6 +598,7 @@ void SpectrumAnalyzerComponent::drawPeakHold(juce::Graphics& g)
     bool pathStarted = false;
     bool hasValidPeaks = false;
     
+    const auto& peakData = analysisEngine->getPeakHold();
     const int numBins = fftSize / 2;
     
     for (int i = 1; i < numBins; ++i)
@@ -384,6 +651,321 @@ void SpectrumAnalyzerComponent::drawPeakHold(juce::Graphics& g)
     }
 }
 
+void SpectrumAnalyzerComponent::drawHistoryTraces(juce::Graphics& g)
+{
+    const auto& history = analysisEngine->getHistory();
+    
+    if (!history.hasData())
+        return;
+    
+    using Trace = SpectrumHistory::Trace;
+    
+    switch (getHistoryDisplay())
+    {
+        case HistoryDisplay::maximum:
+            drawTrace(g, history.getTrace(Trace::maximum), historyMaxColor);
+            break;
+        case HistoryDisplay::minimum:
+            drawTrace(g, history.getTrace(Trace::minimum), historyMinColor);
+            break;
+        case HistoryDisplay::minMax:
+            drawTrace(g, history.getTrace(Trace::minimum), historyMinColor);
+            drawTrace(g, history.getTrace(Trace::maximum), historyMaxColor);
+            break;
+        case HistoryDisplay::average:
+            drawTrace(g, history.getTrace(Trace::average), historyAverageColor);
+            break;
+        case HistoryDisplay::infiniteAverage:
+            drawTrace(g, history.getTrace(Trace::infiniteAverage), historyAverageColor);
+            break;
+        case HistoryDisplay::none:
+            break;
+    }
+}
+
+void SpectrumAnalyzerComponent::drawTrace(juce::Graphics& g, const float* data, juce::Colour colour)
+{
+    juce::Path tracePath;
+    bool pathStarted = false;
+    
+    const int numBins = fftSize / 2;
+    
+    for (int i = 1; i < numBins; ++i)
+    {
+        const float freq = binToFrequency(i);
+        
+        if (freq < minFreq || freq > maxFreq)
+            continue;
+        
+        const float x = frequencyToX(freq);
+        const float y = magnitudeToY(juce::jlimit(mindB, maxdB, data[i]));
+        
+        if (!pathStarted)
+        {
+            tracePath.startNewSubPath(x, y);
+            pathStarted = true;
+        }
+        else
+        {
+            tracePath.lineTo(x, y);
+        }
+    }
+    
+    if (pathStarted)
+    {
+        // Glow
+        g.setColour(colour.withAlpha(0.25f));
+        g.strokePath(tracePath, juce::PathStrokeType(4.0f, juce::PathStrokeType::curved, juce::PathStrokeType::rounded));
+        
+        // Core line
+        g.setColour(colour.withAlpha(0.9f));
+        g.strokePath(tracePath, juce::PathStrokeType(1.2f, juce::PathStrokeType::curved, juce::PathStrokeType::rounded));
+    }
+}
+
+void SpectrumAnalyzerComponent::drawStereoAnalysis(juce::Graphics& g)
+{
+    const auto& snapshot = getSnapshot();
+    const float width = static_cast<float>(getWidth());
+    const float height = static_cast<float>(getHeight());
+    const float stripHeight = height * stereoStripRatio;
+    const float stripTop = height - stripHeight;
+    
+    // Strip background and centre (zero correlation) line
+    g.setColour(backgroundColor1.withAlpha(0.7f));
+    g.fillRect(0.0f, stripTop, width, stripHeight);
+    g.setColour(gridColorMajor.withAlpha(0.5f));
+    g.drawHorizontalLine(static_cast<int>(stripTop), 0.0f, width);
+    g.setColour(gridColor);
+    g.drawHorizontalLine(static_cast<int>(stripTop + stripHeight * 0.5f), 0.0f, width);
+    
+    // Maps -1..1 onto the strip, +1 at the top
+    auto valueToY = [stripTop, stripHeight](float value)
+    {
+        return stripTop + stripHeight * 0.5f * (1.0f - juce::jlimit(-1.0f, 1.0f, value));
+    };
+    
+    juce::Path coherencePath;
+    juce::Path correlationPath;
+    juce::Path widthPath;
+    bool pathStarted = false;
+    float lastX = 0.0f;
+    
+    const int numBins = fftSize / 2;
+    
+    for (int i = 1; i < numBins; ++i)
+    {
+        const float freq = binToFrequency(i);
+        
+        if (freq < minFreq || freq > maxFreq)
+            continue;
+        
+        const float x = frequencyToX(freq);
+        
+        // Coherence and width use the upper half (0..1), correlation the whole strip
+        const float coherenceY = valueToY(snapshot.coherence[i]);
+        const float correlationY = valueToY(snapshot.correlation[i]);
+        const float widthY = valueToY(snapshot.width[i]);
+        
+        if (!pathStarted)
+        {
+            coherencePath.startNewSubPath(x, valueToY(0.0f));
+            coherencePath.lineTo(x, coherenceY);
+            correlationPath.startNewSubPath(x, correlationY);
+            widthPath.startNewSubPath(x, widthY);
+            pathStarted = true;
+        }
+        else
+        {
+            coherencePath.lineTo(x, coherenceY);
+            correlationPath.lineTo(x, correlationY);
+            widthPath.lineTo(x, widthY);
+        }
+        
+        lastX = x;
+    }
+    
+    if (pathStarted)
+    {
+        coherencePath.lineTo(lastX, valueToY(0.0f));
+        coherencePath.closeSubPath();
+        
+        g.setColour(coherenceColor.withAlpha(0.25f));
+        g.fillPath(coherencePath);
+        
+        g.setColour(widthColor.withAlpha(0.8f));
+        g.strokePath(widthPath, juce::PathStrokeType(1.0f));
+        
+        g.setColour(correlationColor.withAlpha(0.3f));
+        g.strokePath(correlationPath, juce::PathStrokeType(3.0f, juce::PathStrokeType::curved, juce::PathStrokeType::rounded));
+        g.setColour(correlationColor);
+        g.strokePath(correlationPath, juce::PathStrokeType(1.2f, juce::PathStrokeType::curved, juce::PathStrokeType::rounded));
+    }
+    
+    // Legend
+    g.setFont(juce::Font(10.0f, juce::Font::bold));
+    const int legendY = static_cast<int>(stripTop) + 2;
+    g.setColour(correlationColor);
+    g.drawText("CORRELATION", 60, legendY, 80, 12, juce::Justification::left);
+    g.setColour(coherenceColor);
+    g.drawText("COHERENCE", 140, legendY, 70, 12, juce::Justification::left);
+    g.setColour(widthColor);
+    g.drawText("WIDTH", 210, legendY, 40, 12, juce::Justification::left);
+    
+    if (!snapshot.isStereo)
+    {
+        g.setColour(textColor.withAlpha(0.6f));
+        g.drawText("MONO INPUT", 250, legendY, 80, 12, juce::Justification::left);
+    }
+}
+
+juce::Path SpectrumAnalyzerComponent::createColumnPath(const float* columns, int numColumns) const
+{
+    juce::Path path;
+    
+    for (int c = 0; c < numColumns; ++c)
+    {
+        const float x = ColumnReducer::getColumnX(c);
+        const float y = magnitudeToY(juce::jlimit(mindB, maxdB, columns[c]));
+        
+        if (c == 0)
+            path.startNewSubPath(x, y);
+        else
+            path.lineTo(x, y);
+    }
+    
+    return path;
+}
+
+void SpectrumAnalyzerComponent::drawReferences(juce::Graphics& g)
+{
+    g.setFont(juce::Font(11.0f, juce::Font::bold));
+    
+    // Each reference is drawn from its cached columns; no per-bin work here
+    for (int i = 0; i < numReferences; ++i)
+    {
+        const int slot = referenceSlots[static_cast<size_t>(i)];
+        const int numColumns = referenceValidColumns[static_cast<size_t>(slot)];
+        const auto& columns = referenceColumns[static_cast<size_t>(slot)];
+        const auto colour = referenceColors[static_cast<size_t>(i) % referenceColors.size()];
+        
+        if (numColumns == 0)
+            continue;
+        
+        const auto path = createColumnPath(columns.data(), numColumns);
+        
+        g.setColour(colour.withAlpha(0.2f));
+        g.strokePath(path, juce::PathStrokeType(3.0f, juce::PathStrokeType::curved, juce::PathStrokeType::rounded));
+        g.setColour(colour.withAlpha(0.75f));
+        g.strokePath(path, juce::PathStrokeType(1.0f, juce::PathStrokeType::curved, juce::PathStrokeType::rounded));
+        
+        // Label at the right end of the trace
+        const float labelY = magnitudeToY(juce::jlimit(mindB, maxdB, columns[static_cast<size_t>(numColumns - 1)]));
+        g.drawText(juce::String::charToString(static_cast<juce::juce_wchar>('A' + i)),
+                   juce::jmax(0, numColumns - 14), static_cast<int>(labelY) - 14, 12, 12,
+                   juce::Justification::centred);
+    }
+}
+
+void SpectrumAnalyzerComponent::drawDifference(juce::Graphics& g)
+{
+    const float width = static_cast<float>(getWidth());
+    const float centreY = static_cast<float>(getHeight()) * 0.5f;
+    const float halfRange = static_cast<float>(getHeight()) * 0.5f;
+    
+    const int slot = referenceSlots[0];
+    const auto& reference = referenceColumns[static_cast<size_t>(slot)];
+    const int numColumns = juce::jmin(columnReducer.getNumValidColumns(),
+                                      referenceValidColumns[static_cast<size_t>(slot)]);
+    
+    // Zero-difference line
+    g.setColour(differenceColor.withAlpha(0.4f));
+    g.drawHorizontalLine(static_cast<int>(centreY), 0.0f, width);
+    
+    juce::Path differencePath;
+    
+    for (int c = 0; c < numColumns; ++c)
+    {
+        const float difference = liveColumns[static_cast<size_t>(c)] - reference[static_cast<size_t>(c)];
+        const float y = centreY - halfRange * juce::jlimit(-1.0f, 1.0f, difference / differenceRangedB);
+        
+        if (c == 0)
+            differencePath.startNewSubPath(ColumnReducer::getColumnX(c), y);
+        else
+            differencePath.lineTo(ColumnReducer::getColumnX(c), y);
+    }
+    
+    g.setColour(differenceColor.withAlpha(0.3f));
+    g.strokePath(differencePath, juce::PathStrokeType(4.0f, juce::PathStrokeType::curved, juce::PathStrokeType::rounded));
+    g.setColour(differenceColor);
+    g.strokePath(differencePath, juce::PathStrokeType(1.5f, juce::PathStrokeType::curved, juce::PathStrokeType::rounded));
+    
+    // Scale labels
+    g.setFont(juce::Font(10.0f, juce::Font::bold));
+    g.drawText("LIVE - A  +" + juce::String(static_cast<int>(differenceRangedB)) + " dB",
+               static_cast<int>(width) - 130, 20, 122, 12, juce::Justification::right);
+    g.drawText("-" + juce::String(static_cast<int>(differenceRangedB)) + " dB",
+               static_cast<int>(width) - 130, getHeight() - 32, 122, 12, juce::Justification::right);
+}
+
+void SpectrumAnalyzerComponent::drawPeakMarkers(juce::Graphics& g)
+{
+    const float width = static_cast<float>(getWidth());
+    const float height = static_cast<float>(getHeight());
+    const float labelWidth = 62.0f;
+    const float labelHeight = 24.0f;
+    
+    const auto& peakDetector = getPeakDetector();
+    g.setFont(juce::Font(10.0f, juce::Font::bold));
+    
+    for (int i = 0; i < peakDetector.getNumPeaks(); ++i)
+    {
+        const auto& peak = peakDetector.getPeak(i);
+        
+        if (peak.frequency < minFreq || peak.frequency > maxFreq)
+            continue;
+        
+        const float x = frequencyToX(peak.frequency);
+        const float y = magnitudeToY(peak.level);
+        
+        // Diamond marker with glow
+        juce::Path diamond;
+        diamond.addTriangle(x - 4.0f, y - 6.0f, x + 4.0f, y - 6.0f, x, y - 1.0f);
+        
+        g.setColour(markerColor.withAlpha(0.3f));
+        g.strokePath(diamond, juce::PathStrokeType(3.0f));
+        g.setColour(markerColor);
+        g.fillPath(diamond);
+        
+        // Label above the marker, kept inside the component
+        const float labelX = juce::jlimit(0.0f, juce::jmax(0.0f, width - labelWidth), x - labelWidth * 0.5f);
+        const float labelY = juce::jlimit(0.0f, juce::jmax(0.0f, height - labelHeight), y - 8.0f - labelHeight);
+        const juce::Rectangle<float> labelArea(labelX, labelY, labelWidth, labelHeight);
+        
+        g.setColour(backgroundColor1.withAlpha(0.6f));
+        g.fillRoundedRectangle(labelArea, 2.0f);
+        
+        g.setColour(markerColor);
+        g.drawFittedText(formatPeakFrequency(peak.frequency) + "\n" + juce::String(peak.level, 1) + " dB",
+                         labelArea.toNearestInt(), juce::Justification::centred, 2);
+    }
+}
+
+void SpectrumAnalyzerComponent::drawLatencyReadout(juce::Graphics& g)
+{
+    if (paintLatency.getNumSamples() == 0)
+        return;
+    
+    const juce::String text = juce::String(isLowLatencyMode() ? "LOW LATENCY  PAINT  " : "PAINT LATENCY  ")
+                            + "p50 " + juce::String(paintLatency.getPercentile(0.5), 1)
+                            + "  p95 " + juce::String(paintLatency.getPercentile(0.95), 1)
+                            + "  max " + juce::String(paintLatency.getMaximum(), 1) + " ms";
+    
+    g.setFont(juce::Font(10.0f, juce::Font::bold));
+    g.setColour(textColor.withAlpha(0.6f));
+    g.drawText(text, getLocalBounds().removeFromTop(18).reduced(8, 0), juce::Justification::centredRight);
+}
+
 //==============================================================================
 float SpectrumAnalyzerComponent::frequencyToX(float freq) const
 {
@@ -437,3 +1019,12 @@ juce::String SpectrumAnalyzerComponent::formatFrequency(float freq) const
     }
     return juce::String(static_cast<int>(freq));
 }
+
+juce::String SpectrumAnalyzerComponent::formatPeakFrequency(float freq) const
+{
+    if (freq >= 1000.0f)
+    {
+        return juce::String(freq / 1000.0f, 3) + " kHz";
+    }
+    return juce::String(freq, 1) + " Hz";
+}
@@ -3,13 +3,20 @@
 #include <juce_gui_basics/juce_gui_basics.h>
 #include <juce_dsp/juce_dsp.h>
 #include <array>
-
-// Forward declaration
-class SpectrumAnalyzerAudioProcessor;
+#include "LatencyMonitor.h"
+#include "SpectrumAnalysisEngine.h"
+#include "SnapshotPool.h"
+#include "ColumnReducer.h"
+#include "SpectrumDisplaySource.h"
 
 //==============================================================================
+// Draws a SpectrumDisplaySource. The plugin processor analyses each frame on
+// the shared AnalysisScheduler tick and tells this component, which repaints.
+// A source without an engine gives a remote display: only the columns passed
+// to setRemoteColumns() are drawn.
 class SpectrumAnalyzerComponent : public juce::Component,
-                                   private juce::Timer
+                                   private juce::ChangeListener,
+                                   private SpectrumDisplaySource::Listener
 {
 public:
     //==============================================================================
@@ -17,7 +24,7 @@ public:
     static constexpr int fftSize = 1 << fftOrder;
 
     //==============================================================================
-    explicit SpectrumAnalyzerComponent(SpectrumAnalyzerAudioProcessor& processor);
+    explicit SpectrumAnalyzerComponent(SpectrumDisplaySource& displaySource);
     ~SpectrumAnalyzerComponent() override;
 
     //==============================================================================
@@ -25,35 +32,146 @@ public:
     void resized() override;
 
     //==============================================================================
+    // Weighting, smoothing and the other settings of the source's analysis
+    // engine; defaults without one. Returned by value: the host may restore
+    // new settings from another thread.
+    void setAnalysisSettings(const AnalysisSettings& settings);
+    AnalysisSettings getAnalysisSettings() const;
+
     void setPeakHoldEnabled(bool enabled);
-    bool isPeakHoldEnabled() const { return peakHoldEnabled; }
+    bool isPeakHoldEnabled() const { return getAnalysisSettings().peakHoldEnabled; }
+
+    void setPeakMarkersEnabled(bool enabled);
+    bool arePeakMarkersEnabled() const;
+
+    // The accessors that return engine data by reference need an engine and
+    // the source's engine lock; paint() holds it while drawing.
+    
+    // Sub-bin refined peaks of the displayed frame, strongest first
+    const PeakDetector& getPeakDetector() const noexcept { return isFrozen() ? frozenPeaks : analysisEngine->getPeakDetector(); }
+
+    // Low-latency mode: overlapping frames, and faster scheduler ticks while they arrive
+    void setLowLatencyMode(bool enabled);
+    bool isLowLatencyMode() const;
+
+    // Latency from the processBlock that completed a frame to the end of
+    // analysis, and to the end of paint(). Paint latency stops when the frame
+    // is drawn into the window's buffer; the compositor and vblank come after.
+    const LatencyMonitor& getAnalysisLatency() const noexcept { return analysisLatency; }
+    const LatencyMonitor& getPaintLatency() const noexcept { return paintLatency; }
+    void resetLatencyStats();
+
+    // Rolling history traces over a time window
+    enum class HistoryDisplay
+    {
+        none,
+        maximum,
+        minimum,
+        minMax,
+        average,
+        infiniteAverage
+    };
+
+    void setHistoryDisplay(HistoryDisplay display);
+    HistoryDisplay getHistoryDisplay() const;
+    void setHistoryWindowSeconds(double seconds);
+    double getHistoryWindowSeconds() const;
+    void resetHistory();
+    const SpectrumHistory& getHistory() const noexcept { return analysisEngine->getHistory(); }
+
+    // Stereo analysis: both channels are transformed and the coherence,
+    // correlation and width spectra are drawn in a strip under the spectrum
+    void setStereoAnalysisEnabled(bool enabled);
+    bool isStereoAnalysisEnabled() const { return getAnalysisSettings().stereoAnalysisEnabled; }
+
+    // Magnitude and stereo results of the displayed frame
+    const SpectrumSnapshot& getSnapshot() const noexcept { return isFrozen() ? snapshotPool.get(frozenSlot) : analysisEngine->getSnapshot(); }
+
+    // Freeze copies the displayed frame into a pool buffer and draws the
+    // spectrum, stereo strip and peak markers from it. Analysis carries on,
+    // so history, peak hold and the stream keep running underneath.
+    void setFrozen(bool shouldBeFrozen);
+    bool isFrozen() const { return frozenSlot >= 0; }
+
+    // Reference overlays (A, B, C...) captured from the displayed spectrum.
+    // Up to maxReferences; one more replaces the oldest. The last pool buffer
+    // is left for Freeze.
+    static constexpr int maxReferences = SnapshotPool::capacity - 1;
+
+    void captureReference();
+    void clearReferences();
+    int getNumReferences() const { return numReferences; }
+    const SpectrumSnapshot& getReference(int index) const;
+
+    // Draws live minus reference A. Not drawn for a remote display, whose
+    // references would come from a different, local analysis.
+    void setDifferenceEnabled(bool enabled);
+    bool isDifferenceEnabled() const { return differenceEnabled; }
+
+    // Remote display: draws columns received from a stream server in place of
+    // the local analysis. The first numValidColumns of numColumns are drawn.
+    // Capture and Difference are ignored while remote.
+    void setRemoteColumns(const float* columns, int numColumns, int numValidColumns, double sampleRate);
 
 private:
     //==============================================================================
-    void timerCallback() override;
+    void analysisUpdated(bool newFrame) override;
+    void changeListenerCallback(juce::ChangeBroadcaster* source) override;
     
     void drawBackground(juce::Graphics& g);
     void drawGrid(juce::Graphics& g);
     void drawSpectrum(juce::Graphics& g);
     void drawPeakHold(juce::Graphics& g);
+    void drawPeakMarkers(juce::Graphics& g);
+    void drawLatencyReadout(juce::Graphics& g);
+    void drawHistoryTraces(juce::Graphics& g);
+    void drawTrace(juce::Graphics& g, const float* data, juce::Colour colour);
+    void drawStereoAnalysis(juce::Graphics& g);
+    void drawReferences(juce::Graphics& g);
+    void drawDifference(juce::Graphics& g);
+    juce::Path createColumnPath(const float* columns, int numColumns) const;
     
-    void updateSpectrumData();
-    void resetPeakData();
+    void updateColumnLayoutIfNeeded();
+    void reduceReference(int slot);
     
     float frequencyToX(float freq) const;
     float magnitudeToY(float dB) const;
     float binToFrequency(int bin) const;
     juce::String formatFrequency(float freq) const;
+    juce::String formatPeakFrequency(float freq) const;
 
     //==============================================================================
-    SpectrumAnalyzerAudioProcessor& audioProcessor;
-
-    // Spectrum data
-    std::array<float, fftSize / 2> spectrumData;
-    std::array<float, fftSize / 2> peakData;
+    SpectrumDisplaySource& source;
     
-    // State
-    bool peakHoldEnabled = true;
+    // Spectrum, peak hold, peaks and history live in the source's engine so
+    // they survive the editor being closed; nullptr for a remote display
+    SpectrumAnalysisEngine* const analysisEngine;
+    
+    // Per-column display reduction
+    ColumnReducer columnReducer;
+    ColumnReducer referenceReducer;  // For references captured at another sample rate
+    std::vector<float> liveColumns;
+    
+    // Columns from a stream server, when used as a remote display
+    std::vector<float> remoteColumns;
+    int remoteValidColumns = 0;
+    bool remoteDisplay = false;
+    
+    // Reference snapshots and their cached column reductions (indexed by pool slot)
+    SnapshotPool snapshotPool;
+    std::array<int, SnapshotPool::capacity> referenceSlots {};
+    std::array<std::vector<float>, SnapshotPool::capacity> referenceColumns;
+    std::array<int, SnapshotPool::capacity> referenceValidColumns {};
+    int numReferences = 0;
+    int frozenSlot = -1;
+    PeakDetector frozenPeaks;
+    bool differenceEnabled = false;
+
+    // Latency measurement
+    LatencyMonitor analysisLatency;
+    LatencyMonitor paintLatency;
+    juce::int64 pendingFrameTimestamp = 0;
+    bool frameAwaitingPaint = false;
     double currentSampleRate = 44100.0;
     
     // Futuristic Cyberpunk Colors
@@ -67,6 +185,20 @@ private:
     const juce::Colour peakGlowColor { 0x80FF00FF };     // Magenta glow
     const juce::Colour textColor { 0xFF00CCFF };         // Cyan text
     const juce::Colour scanlineColor { 0x0800FFFF };     // Subtle scanlines
+    const juce::Colour markerColor { 0xFFFFEE00 };       // Neon yellow markers
+    const juce::Colour historyMaxColor { 0xFFFFAA00 };   // Amber max trace
+    const juce::Colour historyMinColor { 0xFF3399FF };   // Electric blue min trace
+    const juce::Colour historyAverageColor { 0xFFE0E0FF }; // Pale white average trace
+    const juce::Colour correlationColor { 0xFF00FFFF };  // Cyan correlation line
+    const juce::Colour coherenceColor { 0xFFAA55FF };    // Violet coherence fill
+    const juce::Colour widthColor { 0xFFFF66CC };        // Pink width line
+    const juce::Colour differenceColor { 0xFFFF5555 };   // Red difference trace
+    const std::array<juce::Colour, 4> referenceColors {
+        juce::Colour(0xFFFFFFFF),  // A: white
+        juce::Colour(0xFFFF8800),  // B: orange
+        juce::Colour(0xFF88FF00),  // C: lime
+        juce::Colour(0xFF00AAFF)   // D: blue
+    };
 
     // Frequency range
     static constexpr float minFreq = 20.0f;
@@ -76,8 +208,11 @@ private:
     static constexpr float mindB = -100.0f;
     static constexpr float maxdB = 0.0f;
     
-    // Peak decay rate (per frame at 60fps)
-    static constexpr float peakDecayRate = 0.985f;
+    // Share of the height used by the stereo strip
+    static constexpr float stereoStripRatio = 0.25f;
+    
+    // Full-scale range of the difference trace (+/- dB)
+    static constexpr float differenceRangedB = 24.0f;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SpectrumAnalyzerComponent)
 };
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <juce_events/juce_events.h>
+#include "SpectrumAnalysisEngine.h"
+
+//==============================================================================
+// What SpectrumAnalyzerComponent draws from, and where its display choices
+// live so they outlive the editor. The plugin processor is the usual source;
+// the stream client uses a lightweight one with no analysis engine. A change
+// message means the choices were replaced, e.g. by restored state.
+class SpectrumDisplaySource : public juce::ChangeBroadcaster
+{
+public:
+    //==============================================================================
+    // Told on the message thread after each analysis tick that analysed a
+    // frame or decayed the peak hold
+    class Listener
+    {
+    public:
+        virtual ~Listener() = default;
+        virtual void analysisUpdated(bool newFrame) = 0;
+    };
+
+    ~SpectrumDisplaySource() override = default;
+
+    // Local analysis to draw; nullptr when the source has none
+    virtual SpectrumAnalysisEngine* getDisplayedEngine() noexcept = 0;
+
+    // Hold this to read or change the engine. The host may save and restore
+    // state from any thread, so the message thread is not enough on its own.
+    const juce::CriticalSection& getEngineLock() const noexcept { return engineLock; }
+
+    virtual void addDisplayListener(Listener* listener) = 0;
+    virtual void removeDisplayListener(Listener* listener) = 0;
+
+    //==============================================================================
+    // Display choices (message thread). historyDisplay is a
+    // SpectrumAnalyzerComponent::HistoryDisplay.
+    virtual void setPeakMarkersEnabled(bool enabled) = 0;
+    virtual bool arePeakMarkersEnabled() const = 0;
+    virtual void setHistoryDisplay(int display) = 0;
+    virtual int getHistoryDisplay() const = 0;
+    virtual void setLowLatencyMode(bool enabled) = 0;
+    virtual bool isLowLatencyMode() const = 0;
+
+private:
+    juce::CriticalSection engineLock;
+};
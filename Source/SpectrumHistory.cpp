@@ -0,0 +1,287 @@
+#include "SpectrumHistory.h"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    constexpr float emptyTraceDb = -100.0f;
+    constexpr double minimumPower = 1.0e-20;
+
+    // 10^(dB / 10) as 2^(dB * log2(10) / 10): one exp2 in float per bin
+    constexpr float dBToLog2Power = 0.33219281f;
+
+    float dBToPower(float dB) noexcept
+    {
+        return std::exp2(dB * dBToLog2Power);
+    }
+
+    float powerToDb(double power) noexcept
+    {
+        return static_cast<float>(10.0 * std::log10(std::max(power, minimumPower)));
+    }
+}
+
+//==============================================================================
+void SpectrumHistory::prepare(int newNumBins, double frameRateHz, double windowSeconds)
+{
+    newNumBins = std::max(0, newNumBins);
+    const bool keepInfiniteAverage = (newNumBins == numBins);
+    numBins = newNumBins;
+
+    // Short windows use fewer blocks (one frame each) rather than stretching
+    // to numBlocks frames; long ones the fewest blocks that cover the window
+    const double framesInWindow = std::max(1.0, std::ceil(frameRateHz * windowSeconds - 1.0e-9));
+    framesPerBlock = std::max(1, static_cast<int>(std::ceil(framesInWindow / numBlocks)));
+    blocksInUse = std::clamp(static_cast<int>(std::ceil(framesInWindow / framesPerBlock)), 1, numBlocks);
+
+    const auto bins = static_cast<size_t>(numBins);
+
+    pool.assign(static_cast<size_t>(numBlocks) * 4 * bins, 0.0f);
+    sumPool.assign(static_cast<size_t>(numBlocks) * bins, 0.0);
+
+    for (auto* v : { &backMax, &backMin, &currentMax, &currentMin })
+        v->assign(bins, emptyTraceDb);
+
+    for (auto* v : { &windowSum, &currentSum })
+        v->assign(bins, 0.0);
+
+    for (auto& trace : traces)
+        trace.resize(bins, emptyTraceDb);
+
+    // The average since reset doesn't depend on the window, so a new window
+    // length or frame rate keeps it
+    if (!keepInfiniteAverage)
+    {
+        infiniteSum.assign(bins, 0.0);
+        infiniteCount = 0;
+        traces[static_cast<size_t>(Trace::infiniteAverage)].assign(bins, emptyTraceDb);
+    }
+
+    resetWindow();
+}
+
+void SpectrumHistory::reset() noexcept
+{
+    resetWindow();
+
+    infiniteCount = 0;
+    std::fill(infiniteSum.begin(), infiniteSum.end(), 0.0);
+
+    auto& infiniteTrace = traces[static_cast<size_t>(Trace::infiniteAverage)];
+    std::fill(infiniteTrace.begin(), infiniteTrace.end(), emptyTraceDb);
+    staleTraces = 0;
+}
+
+void SpectrumHistory::resetWindow() noexcept
+{
+    head = 0;
+    numStored = 0;
+    frontSize = 0;
+    currentCount = 0;
+
+    std::fill(windowSum.begin(), windowSum.end(), 0.0);
+
+    for (auto trace : { Trace::maximum, Trace::minimum, Trace::average })
+    {
+        auto& values = traces[static_cast<size_t>(trace)];
+        std::fill(values.begin(), values.end(), emptyTraceDb);
+    }
+
+    // Only the average since reset may still hold data
+    staleTraces = infiniteCount > 0 ? (1u << static_cast<int>(Trace::infiniteAverage)) : 0u;
+}
+
+//==============================================================================
+void SpectrumHistory::addFrame(const float* magnitudesDb) noexcept
+{
+    if (numBins == 0)
+        return;
+
+    // The block being filled counts toward the window: starting a new one
+    // when the ring is full drops the oldest, so at most blocksInUse blocks
+    // (blocksInUse * framesPerBlock frames) are ever covered
+    if (currentCount == 0 && numStored == blocksInUse)
+        evictOldestBlock();
+
+    for (int i = 0; i < numBins; ++i)
+    {
+        const float dB = magnitudesDb[i];
+        const double power = dBToPower(dB);
+
+        if (currentCount == 0)
+        {
+            currentMax[i] = dB;
+            currentMin[i] = dB;
+            currentSum[i] = power;
+        }
+        else
+        {
+            currentMax[i] = std::max(currentMax[i], dB);
+            currentMin[i] = std::min(currentMin[i], dB);
+            currentSum[i] += power;
+        }
+
+        infiniteSum[i] += power;
+    }
+
+    ++currentCount;
+    ++infiniteCount;
+
+    if (currentCount == framesPerBlock)
+        completeBlock();
+
+    staleTraces = allTracesStale;
+}
+
+void SpectrumHistory::restoreInfiniteAverage(const float* averageDb, int64_t numFrames) noexcept
+{
+    if (numBins == 0 || numFrames <= 0)
+        return;
+
+    // The sums are rebuilt as if numFrames frames at the average had been added
+    for (int i = 0; i < numBins; ++i)
+        infiniteSum[i] = std::pow(10.0, static_cast<double>(averageDb[i]) * 0.1) * static_cast<double>(numFrames);
+
+    infiniteCount = numFrames;
+    staleTraces |= 1u << static_cast<int>(Trace::infiniteAverage);
+}
+
+const float* SpectrumHistory::getTrace(Trace trace) const noexcept
+{
+    const auto index = static_cast<int>(trace);
+    float* output = traces[static_cast<size_t>(index)].data();
+
+    if ((staleTraces & (1u << index)) == 0)
+        return output;
+
+    switch (trace)
+    {
+        case Trace::maximum:          computeExtreme(true, output); break;
+        case Trace::minimum:          computeExtreme(false, output); break;
+        case Trace::infiniteAverage:  computeAverage(infiniteSum, static_cast<double>(infiniteCount), output); break;
+
+        case Trace::average:
+        {
+            // The running window sum plus the block being filled
+            const double windowCount = static_cast<double>(numStored) * framesPerBlock + currentCount;
+            const double inverseCount = windowCount > 0.0 ? 1.0 / windowCount : 0.0;
+
+            for (int i = 0; i < numBins; ++i)
+                output[i] = powerToDb((windowSum[i] + (currentCount > 0 ? currentSum[i] : 0.0)) * inverseCount);
+
+            break;
+        }
+    }
+
+    staleTraces &= ~(1u << index);
+    return output;
+}
+
+//==============================================================================
+void SpectrumHistory::completeBlock() noexcept
+{
+    const int slot = (head + numStored) % numBlocks;
+    const bool backWasEmpty = (numStored == frontSize);
+
+    std::copy(currentMax.begin(), currentMax.end(), blockMax(slot));
+    std::copy(currentMin.begin(), currentMin.end(), blockMin(slot));
+    std::copy(currentSum.begin(), currentSum.end(), blockSum(slot));
+
+    for (int i = 0; i < numBins; ++i)
+    {
+        windowSum[i] += currentSum[i];
+        backMax[i] = backWasEmpty ? currentMax[i] : std::max(backMax[i], currentMax[i]);
+        backMin[i] = backWasEmpty ? currentMin[i] : std::min(backMin[i], currentMin[i]);
+    }
+
+    ++numStored;
+    currentCount = 0;
+}
+
+void SpectrumHistory::evictOldestBlock() noexcept
+{
+    if (frontSize == 0)
+        flipBackToFront();
+
+    const double* oldest = blockSum(head);
+
+    for (int i = 0; i < numBins; ++i)
+        windowSum[i] -= oldest[i];
+
+    head = (head + 1) % numBlocks;
+    --numStored;
+    --frontSize;
+}
+
+void SpectrumHistory::flipBackToFront() noexcept
+{
+    // Rebuild suffix aggregates newest to oldest; runs once every blocksInUse blocks
+    std::fill(windowSum.begin(), windowSum.end(), 0.0);
+
+    for (int j = numStored - 1; j >= 0; --j)
+    {
+        const int slot = (head + j) % numBlocks;
+        const int next = (slot + 1) % numBlocks;
+        const bool isNewest = (j == numStored - 1);
+
+        const float* bMax = blockMax(slot);
+        const float* bMin = blockMin(slot);
+        const double* bSum = blockSum(slot);
+        float* sMax = suffixMax(slot);
+        float* sMin = suffixMin(slot);
+        const float* nextMax = suffixMax(next);
+        const float* nextMin = suffixMin(next);
+
+        for (int i = 0; i < numBins; ++i)
+        {
+            sMax[i] = isNewest ? bMax[i] : std::max(bMax[i], nextMax[i]);
+            sMin[i] = isNewest ? bMin[i] : std::min(bMin[i], nextMin[i]);
+
+            // Re-summing here also discards any rounding drift of the running sum
+            windowSum[i] += bSum[i];
+        }
+    }
+
+    frontSize = numStored;
+}
+
+void SpectrumHistory::computeExtreme(bool maximum, float* output) const noexcept
+{
+    // The block being filled, the front stack's suffix at the head and the
+    // back stack's running aggregate, whichever hold frames
+    std::array<const float*, 3> parts {};
+    int numParts = 0;
+
+    if (currentCount > 0)
+        parts[static_cast<size_t>(numParts++)] = maximum ? currentMax.data() : currentMin.data();
+
+    if (frontSize > 0)
+        parts[static_cast<size_t>(numParts++)] = maximum ? suffixMax(head) : suffixMin(head);
+
+    if (numStored > frontSize)
+        parts[static_cast<size_t>(numParts++)] = maximum ? backMax.data() : backMin.data();
+
+    if (numParts == 0)
+    {
+        std::fill(output, output + numBins, emptyTraceDb);
+        return;
+    }
+
+    for (int i = 0; i < numBins; ++i)
+    {
+        float value = parts[0][i];
+
+        for (int p = 1; p < numParts; ++p)
+            value = maximum ? std::max(value, parts[static_cast<size_t>(p)][i]) : std::min(value, parts[static_cast<size_t>(p)][i]);
+
+        output[i] = value;
+    }
+}
+
+void SpectrumHistory::computeAverage(const std::vector<double>& sum, double count, float* output) const noexcept
+{
+    const double inverseCount = 1.0 / std::max(1.0, count);
+
+    for (int i = 0; i < numBins; ++i)
+        output[i] = powerToDb(sum[static_cast<size_t>(i)] * inverseCount);
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+//==============================================================================
+// Rolling max, rolling min and linear (power) average of a dB spectrum over a
+// time window, plus an average since the last reset.
+//
+// Frames are folded into at most numBlocks blocks that span the window (one
+// frame per block when the window holds fewer frames than that). Completed
+// blocks sit in a ring handled as a two-stack queue: blocks on the front stack
+// carry suffix aggregates, the back stack keeps one running aggregate, so the
+// window max/min is three lookups per bin. Each frame costs amortised O(bins)
+// whatever the window length, and all storage is allocated once in prepare().
+// The dB traces are only worked out when asked for, so the power-to-dB
+// conversion runs once per drawn trace rather than for every trace per frame.
+class SpectrumHistory
+{
+public:
+    //==============================================================================
+    static constexpr int numBlocks = 32;
+
+    enum class Trace
+    {
+        maximum,
+        minimum,
+        average,
+        infiniteAverage
+    };
+
+    //==============================================================================
+    // Allocates storage for the given window; not real-time safe. The
+    // windowed traces start afresh, the average since reset carries on as long
+    // as numBins stays the same.
+    void prepare(int numBins, double frameRateHz, double windowSeconds);
+    void reset() noexcept;
+
+    // Adds a frame of numBins dB values
+    void addFrame(const float* magnitudesDb) noexcept;
+
+    // numBins dB values, brought up to date on first use after a frame
+    const float* getTrace(Trace trace) const noexcept;
+    int getNumBins() const noexcept { return numBins; }
+    int getFramesPerBlock() const noexcept { return framesPerBlock; }
+    int getNumBlocksInUse() const noexcept { return blocksInUse; }
+    bool hasData() const noexcept { return infiniteCount > 0; }
+
+    // Average since reset and the number of frames it covers, for saving;
+    // restoring replaces it (call after prepare(), no allocation)
+    int64_t getInfiniteCount() const noexcept { return infiniteCount; }
+    void restoreInfiniteAverage(const float* averageDb, int64_t numFrames) noexcept;
+
+private:
+    //==============================================================================
+    // Each ring slot owns four consecutive rows of the pool
+    size_t poolOffset(int slot, int row) const noexcept { return (static_cast<size_t>(slot) * 4 + static_cast<size_t>(row)) * static_cast<size_t>(numBins); }
+    float* blockMax(int slot) noexcept  { return pool.data() + poolOffset(slot, 0); }
+    float* blockMin(int slot) noexcept  { return pool.data() + poolOffset(slot, 1); }
+    float* suffixMax(int slot) noexcept { return pool.data() + poolOffset(slot, 2); }
+    float* suffixMin(int slot) noexcept { return pool.data() + poolOffset(slot, 3); }
+    const float* suffixMax(int slot) const noexcept { return pool.data() + poolOffset(slot, 2); }
+    const float* suffixMin(int slot) const noexcept { return pool.data() + poolOffset(slot, 3); }
+    double* blockSum(int slot) noexcept { return sumPool.data() + static_cast<size_t>(slot) * static_cast<size_t>(numBins); }
+
+    void resetWindow() noexcept;
+    void completeBlock() noexcept;
+    void evictOldestBlock() noexcept;
+    void flipBackToFront() noexcept;
+    void computeExtreme(bool maximum, float* output) const noexcept;
+    void computeAverage(const std::vector<double>& sum, double count, float* output) const noexcept;
+
+    //==============================================================================
+    int numBins = 0;
+    int framesPerBlock = 1;
+    int blocksInUse = numBlocks;  // Blocks spanning the window, at most numBlocks
+
+    // Preallocated per-block storage: max, min and their suffix aggregates per slot
+    std::vector<float> pool;
+    std::vector<double> sumPool;
+
+    // Ring of completed blocks: [head, head + frontSize) is the front stack
+    int head = 0;
+    int numStored = 0;
+    int frontSize = 0;
+
+    // Running aggregates of the back stack and of the whole window
+    std::vector<float> backMax, backMin;
+    std::vector<double> windowSum;
+
+    // Block currently being filled
+    std::vector<float> currentMax, currentMin;
+    std::vector<double> currentSum;
+    int currentCount = 0;
+
+    // Average since reset
+    std::vector<double> infiniteSum;
+    int64_t infiniteCount = 0;
+
+    // Outputs in dB, indexed by Trace, and a bit per trace that is out of date
+    static constexpr int numTraces = 4;
+    static constexpr std::uint32_t allTracesStale = (1u << numTraces) - 1u;
+
+    mutable std::array<std::vector<float>, numTraces> traces;
+    mutable std::uint32_t staleTraces = 0;
+};
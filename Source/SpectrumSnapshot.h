@@ -0,0 +1,25 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <array>
+
+//==============================================================================
+// Everything the display publishes for one analysis frame. The magnitude
+// spectrum and the stereo measurements come from the same pair of transforms
+// and always describe the same audio.
+struct SpectrumSnapshot
+{
+    static constexpr int fftOrder = 12;
+    static constexpr int fftSize = 1 << fftOrder;
+    static constexpr int numBins = fftSize / 2;
+
+    std::array<float, numBins> magnitude {};    // Smoothed mid (L+R)/2 level, dB
+    std::array<float, numBins> coherence {};    // Magnitude-squared coherence, 0..1
+    std::array<float, numBins> phase {};        // Phase of L relative to R, radians
+    std::array<float, numBins> correlation {};  // Normalised real cross-spectrum, -1..1
+    std::array<float, numBins> width {};        // Side share of energy, 0 (mono)..1 (anti-phase)
+
+    double sampleRate = 44100.0;
+    juce::int64 timestamp = 0;  // Ticks of the processBlock that completed the frame
+    bool isStereo = false;
+};
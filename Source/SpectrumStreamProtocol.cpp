@@ -0,0 +1,278 @@
+#include "SpectrumStreamProtocol.h"
+#include <cstring>
+
+namespace SpectrumStreamProtocol
+{
+    namespace
+    {
+        constexpr int maxRunLength = 0x7f;
+        constexpr int nibbleFlag = 0x80;
+
+        void writeUint16(std::vector<std::uint8_t>& dest, int value)
+        {
+            dest.push_back(static_cast<std::uint8_t>(value & 0xff));
+            dest.push_back(static_cast<std::uint8_t>((value >> 8) & 0xff));
+        }
+
+        void writeUint32(std::vector<std::uint8_t>& dest, juce::uint32 value)
+        {
+            for (int shift = 0; shift < 32; shift += 8)
+                dest.push_back(static_cast<std::uint8_t>((value >> shift) & 0xff));
+        }
+
+        void patchUint32(std::vector<std::uint8_t>& dest, size_t position, juce::uint32 value)
+        {
+            for (int i = 0; i < 4; ++i)
+                dest[position + static_cast<size_t>(i)] = static_cast<std::uint8_t>((value >> (8 * i)) & 0xff);
+        }
+
+        // Non-blocking reads until size bytes are in or the deadline passes
+        bool readWithDeadline(juce::StreamingSocket& socket, std::uint8_t* dest, int size, juce::uint32 deadline)
+        {
+            int numRead = 0;
+
+            while (numRead < size)
+            {
+                // Signed difference survives the counter wrapping
+                const auto remainingMs = static_cast<int>(deadline - juce::Time::getMillisecondCounter());
+
+                if (remainingMs <= 0 || socket.waitUntilReady(true, remainingMs) != 1)
+                    return false;
+
+                const int numThisTime = socket.read(dest + numRead, size - numRead, false);
+
+                // Readable with nothing to read means the peer closed
+                if (numThisTime <= 0)
+                    return false;
+
+                numRead += numThisTime;
+            }
+
+            return true;
+        }
+
+        int readUint16(const std::uint8_t* data) noexcept
+        {
+            return data[0] | (data[1] << 8);
+        }
+
+        juce::uint32 readUint32(const std::uint8_t* data) noexcept
+        {
+            return static_cast<juce::uint32>(data[0])
+                 | (static_cast<juce::uint32>(data[1]) << 8)
+                 | (static_cast<juce::uint32>(data[2]) << 16)
+                 | (static_cast<juce::uint32>(data[3]) << 24);
+        }
+    }
+
+    //==============================================================================
+    void encodeFrame(const FrameInfo& info, const std::uint8_t* current, const std::uint8_t* previous,
+                     std::vector<std::uint8_t>& dest)
+    {
+        jassert(info.numColumns <= maxColumns && info.numValidColumns <= info.numColumns);
+
+        const size_t lengthPosition = dest.size();
+        writeUint32(dest, 0);
+
+        const size_t bodyStart = dest.size();
+        dest.push_back(info.isKeyFrame ? keyFrame : deltaFrame);
+        writeUint32(dest, info.sequence);
+
+        juce::uint32 sampleRateBits;
+        std::memcpy(&sampleRateBits, &info.sampleRate, sizeof(sampleRateBits));
+        writeUint32(dest, sampleRateBits);
+
+        writeUint16(dest, info.numColumns);
+        writeUint16(dest, info.numValidColumns);
+
+        const int numValid = info.numValidColumns;
+        const size_t payloadStart = dest.size();
+
+        if (!info.isKeyFrame)
+        {
+            int c = 0;
+
+            while (c < numValid)
+            {
+                int unchanged = 0;
+
+                while (c + unchanged < numValid && unchanged < 255 && current[c + unchanged] == previous[c + unchanged])
+                    ++unchanged;
+
+                c += unchanged;
+
+                int changed = 0;
+                bool fitsNibbles = true;
+
+                while (c + changed < numValid && changed < maxRunLength && current[c + changed] != previous[c + changed])
+                {
+                    const int delta = current[c + changed] - previous[c + changed];
+                    fitsNibbles = fitsNibbles && delta >= -8 && delta <= 7;
+                    ++changed;
+                }
+
+                dest.push_back(static_cast<std::uint8_t>(unchanged));
+                dest.push_back(static_cast<std::uint8_t>(changed | (fitsNibbles ? nibbleFlag : 0)));
+
+                if (fitsNibbles)
+                {
+                    for (int i = 0; i < changed; i += 2)
+                    {
+                        const int low = (current[c + i] - previous[c + i]) & 0x0f;
+                        const int high = i + 1 < changed ? (current[c + i + 1] - previous[c + i + 1]) & 0x0f : 0;
+                        dest.push_back(static_cast<std::uint8_t>(low | (high << 4)));
+                    }
+                }
+                else
+                {
+                    for (int i = 0; i < changed; ++i)
+                        dest.push_back(static_cast<std::uint8_t>(current[c + i] - previous[c + i]));
+                }
+
+                c += changed;
+            }
+
+            // Not worth it: rewrite as a key frame
+            if (dest.size() - payloadStart >= static_cast<size_t>(numValid))
+            {
+                dest.resize(payloadStart);
+                dest[bodyStart] = keyFrame;
+            }
+        }
+
+        if (dest[bodyStart] == keyFrame)
+            dest.insert(dest.end(), current, current + numValid);
+
+        patchUint32(dest, lengthPosition, static_cast<juce::uint32>(dest.size() - bodyStart));
+    }
+
+    bool decodeFrame(const std::uint8_t* body, int size, FrameInfo& info, std::vector<std::uint8_t>& columns)
+    {
+        if (size < headerSize || (body[0] != keyFrame && body[0] != deltaFrame))
+            return false;
+
+        info.isKeyFrame = body[0] == keyFrame;
+        info.sequence = readUint32(body + 1);
+
+        const juce::uint32 sampleRateBits = readUint32(body + 5);
+        std::memcpy(&info.sampleRate, &sampleRateBits, sizeof(info.sampleRate));
+
+        info.numColumns = readUint16(body + 9);
+        info.numValidColumns = readUint16(body + 11);
+
+        if (info.numColumns > maxColumns || info.numValidColumns > info.numColumns)
+            return false;
+
+        const std::uint8_t* payload = body + headerSize;
+        const int payloadSize = size - headerSize;
+        const int numValid = info.numValidColumns;
+
+        if (info.isKeyFrame)
+        {
+            if (payloadSize != numValid)
+                return false;
+
+            columns.assign(payload, payload + numValid);
+            columns.resize(static_cast<size_t>(info.numColumns), 0);
+            return true;
+        }
+
+        // A delta only applies on top of a frame with the same layout
+        if (static_cast<int>(columns.size()) != info.numColumns)
+            return false;
+
+        int position = 0;
+        int c = 0;
+
+        while (c < numValid)
+        {
+            if (position + 2 > payloadSize)
+                return false;
+
+            const int unchanged = payload[position];
+            const bool nibbles = (payload[position + 1] & nibbleFlag) != 0;
+            const int changed = payload[position + 1] & maxRunLength;
+            const int deltaBytes = nibbles ? (changed + 1) / 2 : changed;
+            position += 2;
+
+            if (c + unchanged + changed > numValid || position + deltaBytes > payloadSize)
+                return false;
+
+            c += unchanged;
+
+            for (int i = 0; i < changed; ++i)
+            {
+                int delta = nibbles ? (payload[position + i / 2] >> ((i & 1) * 4)) & 0x0f
+                                    : payload[position + i];
+
+                if (nibbles && delta >= 8)
+                    delta -= 16;
+
+                auto& column = columns[static_cast<size_t>(c + i)];
+                column = static_cast<std::uint8_t>(column + delta);
+            }
+
+            position += deltaBytes;
+            c += changed;
+
+            // A token must make progress
+            if (unchanged + changed == 0)
+                return false;
+        }
+
+        return position == payloadSize;
+    }
+
+    //==============================================================================
+    void encodeColumnRequest(int numColumns, std::vector<std::uint8_t>& dest)
+    {
+        writeUint32(dest, 3);
+        dest.push_back(columnRequest);
+        writeUint16(dest, juce::jlimit(0, maxColumns, numColumns));
+    }
+
+    bool decodeColumnRequest(const std::uint8_t* body, int size, int& numColumns) noexcept
+    {
+        if (size != 3 || body[0] != columnRequest)
+            return false;
+
+        numColumns = juce::jlimit(1, maxColumns, readUint16(body + 1));
+        return true;
+    }
+
+    TakeResult takeMessage(std::vector<std::uint8_t>& inbox, std::vector<std::uint8_t>& body)
+    {
+        if (inbox.size() < 4)
+            return TakeResult::incomplete;
+
+        const auto length = readUint32(inbox.data());
+
+        if (length == 0 || length > static_cast<juce::uint32>(maxMessageSize))
+            return TakeResult::malformed;
+
+        if (inbox.size() < 4 + static_cast<size_t>(length))
+            return TakeResult::incomplete;
+
+        body.assign(inbox.begin() + 4, inbox.begin() + 4 + length);
+        inbox.erase(inbox.begin(), inbox.begin() + 4 + length);
+        return TakeResult::complete;
+    }
+
+    bool readMessage(juce::StreamingSocket& socket, std::vector<std::uint8_t>& body, int timeoutMs)
+    {
+        const auto deadline = juce::Time::getMillisecondCounter() + static_cast<juce::uint32>(juce::jmax(0, timeoutMs));
+
+        std::uint8_t lengthBytes[4];
+
+        if (!readWithDeadline(socket, lengthBytes, 4, deadline))
+            return false;
+
+        const auto length = readUint32(lengthBytes);
+
+        if (length == 0 || length > static_cast<juce::uint32>(maxMessageSize))
+            return false;
+
+        body.resize(length);
+        return readWithDeadline(socket, body.data(), static_cast<int>(length), deadline);
+    }
+}
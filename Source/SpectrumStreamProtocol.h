@@ -0,0 +1,99 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <cstdint>
+#include <vector>
+
+//==============================================================================
+// Wire format of the spectrum stream. Every message is a little-endian uint32
+// body length followed by the body.
+//
+// Client -> server, request (sent on connect and whenever the width changes):
+//   uint8 type = columnRequest, uint16 numColumns
+//
+// Server -> client, one per analysed frame:
+//   uint8 type = keyFrame | deltaFrame, uint32 sequence, float sampleRate,
+//   uint16 numColumns, uint16 numValidColumns, payload
+//
+// Columns are dB values quantized to quantStepdB steps, one byte each. A key
+// frame carries numValidColumns bytes. A delta frame is relative to the
+// previous frame and carries tokens until all columns are covered:
+//   uint8 unchanged, uint8 changed (low 7 bits = count, top bit = nibbles),
+//   then the changed deltas as signed 4-bit nibbles (two per byte, low first)
+//   or as bytes taken modulo 256.
+// The encoder falls back to a key frame when a delta would not be smaller.
+namespace SpectrumStreamProtocol
+{
+    //==============================================================================
+    enum MessageType : std::uint8_t
+    {
+        columnRequest = 1,
+        keyFrame = 2,
+        deltaFrame = 3
+    };
+
+    static constexpr int defaultPort = 50321;
+    static constexpr int headerSize = 13;
+    static constexpr int maxColumns = 4096;
+    static constexpr int maxMessageSize = headerSize + 3 * maxColumns;
+
+    // Same range as the display
+    static constexpr float minFrequency = 20.0f;
+    static constexpr float maxFrequency = 20000.0f;
+    static constexpr float mindB = -100.0f;
+    static constexpr float maxdB = 0.0f;
+    static constexpr float quantStepdB = 0.5f;
+
+    inline std::uint8_t quantize(float dB) noexcept
+    {
+        const float steps = (juce::jlimit(mindB, maxdB, dB) - mindB) / quantStepdB;
+        return static_cast<std::uint8_t>(steps + 0.5f);
+    }
+
+    inline float dequantize(std::uint8_t value) noexcept
+    {
+        return mindB + static_cast<float>(value) * quantStepdB;
+    }
+
+    //==============================================================================
+    struct FrameInfo
+    {
+        bool isKeyFrame = true;
+        juce::uint32 sequence = 0;
+        float sampleRate = 0.0f;
+        int numColumns = 0;
+        int numValidColumns = 0;
+    };
+
+    // Appends one length-prefixed frame message to dest. previous is the
+    // quantized frame the client holds, ignored for key frames.
+    void encodeFrame(const FrameInfo& info, const std::uint8_t* current, const std::uint8_t* previous,
+                     std::vector<std::uint8_t>& dest);
+
+    // Decodes a frame body (without the length prefix) into columns, which
+    // holds the client's current quantized frame. Returns false on malformed input.
+    bool decodeFrame(const std::uint8_t* body, int size, FrameInfo& info, std::vector<std::uint8_t>& columns);
+
+    // Appends one length-prefixed column request
+    void encodeColumnRequest(int numColumns, std::vector<std::uint8_t>& dest);
+
+    // Decodes a request body (without the length prefix); numColumns is
+    // clamped to 1..maxColumns. Returns false if it is not a column request.
+    bool decodeColumnRequest(const std::uint8_t* body, int size, int& numColumns) noexcept;
+
+    enum class TakeResult
+    {
+        complete,
+        incomplete,
+        malformed
+    };
+
+    // Moves the first length-prefixed message out of inbox into body. A
+    // partial message is left in inbox for more bytes to arrive.
+    TakeResult takeMessage(std::vector<std::uint8_t>& inbox, std::vector<std::uint8_t>& body);
+
+    // Reads one length-prefixed message from a socket into body. The whole
+    // message must arrive within timeoutMs; false on error, bad length or
+    // timeout, after which the stream is out of step and should be closed.
+    bool readMessage(juce::StreamingSocket& socket, std::vector<std::uint8_t>& body, int timeoutMs);
+}
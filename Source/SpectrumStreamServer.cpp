@@ -0,0 +1,269 @@
+#include "SpectrumStreamServer.h"
+#include <algorithm>
+
+//==============================================================================
+// Accepts connections and hands them straight to the sender thread, which
+// reads the column requests without blocking
+class SpectrumStreamServer::Listener : public juce::Thread
+{
+public:
+    explicit Listener(SpectrumStreamServer& serverToUse)
+        : juce::Thread("Spectrum stream listener"),
+          server(serverToUse)
+    {
+    }
+
+    bool bind(int portNumber)
+    {
+        return socket.createListener(portNumber, "127.0.0.1");
+    }
+
+    void close()
+    {
+        // Unblocks waitForNextConnection()
+        socket.close();
+    }
+
+    void run() override
+    {
+        while (!threadShouldExit())
+        {
+            std::unique_ptr<juce::StreamingSocket> connection(socket.waitForNextConnection());
+
+            if (connection == nullptr)
+                break;
+
+            auto client = std::make_unique<Client>();
+            client->socket = std::move(connection);
+            client->waitingSince = juce::Time::getMillisecondCounter();
+
+            const juce::ScopedLock sl(server.pendingLock);
+            server.pendingClients.push_back(std::move(client));
+        }
+    }
+
+private:
+    SpectrumStreamServer& server;
+    juce::StreamingSocket socket;
+};
+
+//==============================================================================
+SpectrumStreamServer::SpectrumStreamServer()
+    : juce::Thread("Spectrum stream sender")
+{
+    for (auto& frame : frames)
+        frame.magnitude.fill(SpectrumStreamProtocol::mindB);
+
+    message.reserve(static_cast<size_t>(SpectrumStreamProtocol::maxMessageSize + 4));
+}
+
+SpectrumStreamServer::~SpectrumStreamServer()
+{
+    stop();
+}
+
+bool SpectrumStreamServer::start(int portNumber)
+{
+    stop();
+
+    listener = std::make_unique<Listener>(*this);
+
+    if (!listener->bind(portNumber))
+    {
+        listener.reset();
+        return false;
+    }
+
+    port = portNumber;
+    running = true;
+    listener->startThread();
+    startThread();
+    return true;
+}
+
+void SpectrumStreamServer::stop()
+{
+    if (!running)
+        return;
+
+    if (listener != nullptr)
+    {
+        listener->signalThreadShouldExit();
+        listener->close();
+        listener->stopThread(2000);
+        listener.reset();
+    }
+
+    stopThread(2000);
+
+    clients.clear();
+    pendingClients.clear();
+    numClients.store(0);
+    running = false;
+}
+
+//==============================================================================
+void SpectrumStreamServer::publish(const SpectrumSnapshot& snapshot) noexcept
+{
+    auto& frame = frames[static_cast<size_t>(writeIndex)];
+    frame.magnitude = snapshot.magnitude;
+    frame.sampleRate = snapshot.sampleRate;
+
+    // Swap the filled buffer in; whatever the sender had not picked up is dropped
+    const int previous = exchangeState.exchange(writeIndex | newFrameBit, std::memory_order_acq_rel);
+    writeIndex = previous & indexMask;
+
+    notify();
+}
+
+bool SpectrumStreamServer::acquireLatestFrame() noexcept
+{
+    if ((exchangeState.load(std::memory_order_acquire) & newFrameBit) == 0)
+        return false;
+
+    const int previous = exchangeState.exchange(readIndex, std::memory_order_acq_rel);
+    readIndex = previous & indexMask;
+    return true;
+}
+
+//==============================================================================
+void SpectrumStreamServer::run()
+{
+    while (!threadShouldExit())
+    {
+        // Woken by publish(); the timeout keeps new clients and requests moving
+        wait(100);
+
+        adoptPendingClients();
+
+        for (auto& client : clients)
+            readRequests(*client);
+
+        if (acquireLatestFrame())
+        {
+            ++sequence;
+
+            for (auto& client : clients)
+                if (client->connected)
+                    sendFrame(*client, frames[static_cast<size_t>(readIndex)]);
+        }
+
+        clients.erase(std::remove_if(clients.begin(), clients.end(),
+                                     [](const auto& client) { return !client->connected; }),
+                      clients.end());
+
+        numClients.store(static_cast<int>(clients.size()), std::memory_order_relaxed);
+    }
+}
+
+void SpectrumStreamServer::adoptPendingClients()
+{
+    const juce::ScopedLock sl(pendingLock);
+
+    for (auto& client : pendingClients)
+        clients.push_back(std::move(client));
+
+    pendingClients.clear();
+}
+
+void SpectrumStreamServer::readRequests(Client& client)
+{
+    using SpectrumStreamProtocol::TakeResult;
+
+    const auto now = juce::Time::getMillisecondCounter();
+
+    // Non-blocking: take what has already arrived, at most one chunk per pass
+    if (client.socket->waitUntilReady(true, 0) == 1)
+    {
+        const auto oldSize = client.inbox.size();
+        client.inbox.resize(oldSize + static_cast<size_t>(readChunkSize));
+
+        const int numRead = client.socket->read(client.inbox.data() + oldSize, readChunkSize, false);
+
+        // Readable with nothing to read means the peer closed
+        if (numRead <= 0)
+        {
+            client.connected = false;
+            return;
+        }
+
+        client.inbox.resize(oldSize + static_cast<size_t>(numRead));
+    }
+
+    for (;;)
+    {
+        const auto result = SpectrumStreamProtocol::takeMessage(client.inbox, requestBody);
+
+        if (result == TakeResult::incomplete)
+            break;
+
+        if (result == TakeResult::malformed)
+        {
+            client.connected = false;
+            return;
+        }
+
+        // Clamped, so a client can't make us build oversized frames or buffers
+        SpectrumStreamProtocol::decodeColumnRequest(requestBody.data(), static_cast<int>(requestBody.size()),
+                                                    client.numColumns);
+    }
+
+    // Owing bytes: no request yet, or half a message in the inbox
+    const bool waitingForClient = client.numColumns <= 0 || !client.inbox.empty();
+
+    if (!waitingForClient)
+        client.waitingSince = now;
+    else if (static_cast<int>(now - client.waitingSince) > requestTimeoutMs)
+        client.connected = false;
+}
+
+void SpectrumStreamServer::sendFrame(Client& client, const PublishedFrame& frame)
+{
+    if (client.numColumns <= 0 || frame.sampleRate <= 0.0)
+        return;
+
+    // Stale frames are skipped rather than queued behind a slow reader
+    if (client.socket->waitUntilReady(false, 0) != 1)
+    {
+        framesDropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    if (!client.reducer.isPreparedFor(client.numColumns, frame.sampleRate))
+    {
+        client.reducer.prepare(client.numColumns, SpectrumSnapshot::numBins, frame.sampleRate, SpectrumSnapshot::fftSize,
+                               SpectrumStreamProtocol::minFrequency, SpectrumStreamProtocol::maxFrequency);
+
+        const auto size = static_cast<size_t>(client.numColumns);
+        client.columns.assign(size, SpectrumStreamProtocol::mindB);
+        client.current.assign(size, 0);
+        client.sent.assign(size, 0);
+        client.needsKeyFrame = true;
+    }
+
+    client.reducer.reduce(frame.magnitude.data(), client.columns.data());
+
+    const int numValid = client.reducer.getNumValidColumns();
+
+    for (int c = 0; c < numValid; ++c)
+        client.current[static_cast<size_t>(c)] = SpectrumStreamProtocol::quantize(client.columns[static_cast<size_t>(c)]);
+
+    SpectrumStreamProtocol::FrameInfo info;
+    info.isKeyFrame = client.needsKeyFrame;
+    info.sequence = sequence;
+    info.sampleRate = static_cast<float>(frame.sampleRate);
+    info.numColumns = client.numColumns;
+    info.numValidColumns = numValid;
+
+    message.clear();
+    SpectrumStreamProtocol::encodeFrame(info, client.current.data(), client.sent.data(), message);
+
+    if (client.socket->write(message.data(), static_cast<int>(message.size())) != static_cast<int>(message.size()))
+    {
+        client.connected = false;
+        return;
+    }
+
+    std::swap(client.current, client.sent);
+    client.needsKeyFrame = false;
+}
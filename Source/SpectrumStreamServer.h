@@ -0,0 +1,108 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <array>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include "ColumnReducer.h"
+#include "SpectrumSnapshot.h"
+#include "SpectrumStreamProtocol.h"
+
+//==============================================================================
+// Streams analysed spectra to display clients on the loopback interface.
+// Each client asks for a column count; the server reduces every frame to that
+// width with the display's ColumnReducer, quantizes it and sends it as a key
+// or delta frame (see SpectrumStreamProtocol).
+//
+// publish() copies the frame into a triple buffer and returns; it never waits
+// for the network. The sender thread only ever looks at the newest frame, and
+// a client whose socket is not ready to write skips frames until it is, so a
+// slow client sees fewer frames rather than older ones.
+//
+// Requests are read without blocking into a per-client inbox, so a client
+// that trickles bytes only holds up itself. A client that has not completed
+// its first request, or stalls partway through one, is dropped after
+// requestTimeoutMs.
+class SpectrumStreamServer : private juce::Thread
+{
+public:
+    //==============================================================================
+    SpectrumStreamServer();
+    ~SpectrumStreamServer() override;
+
+    // Binds to 127.0.0.1:port and starts serving; false if the port is taken
+    bool start(int port = SpectrumStreamProtocol::defaultPort);
+    void stop();
+    bool isRunning() const noexcept { return running.load(std::memory_order_relaxed); }
+    int getPort() const noexcept { return port; }
+
+    //==============================================================================
+    // Hands over the latest analysed frame. Call from one thread only.
+    void publish(const SpectrumSnapshot& snapshot) noexcept;
+
+    int getNumClients() const noexcept { return numClients.load(std::memory_order_relaxed); }
+
+    // Frames skipped for clients that were not ready to receive them
+    juce::uint64 getNumFramesDropped() const noexcept { return framesDropped.load(std::memory_order_relaxed); }
+
+private:
+    //==============================================================================
+    struct Client
+    {
+        std::unique_ptr<juce::StreamingSocket> socket;
+        ColumnReducer reducer;
+        int numColumns = 0;
+        std::vector<float> columns;
+        std::vector<std::uint8_t> current;
+        std::vector<std::uint8_t> sent;   // Last frame the client holds
+        std::vector<std::uint8_t> inbox;  // Request bytes not yet parsed
+        juce::uint32 waitingSince = 0;    // Last time the client owed us no bytes
+        bool needsKeyFrame = true;
+        bool connected = true;
+    };
+
+    static constexpr int requestTimeoutMs = 2000;
+    static constexpr int readChunkSize = 256;
+
+    struct PublishedFrame
+    {
+        std::array<float, SpectrumSnapshot::numBins> magnitude;
+        double sampleRate = 0.0;
+    };
+
+    class Listener;
+
+    void run() override;
+    bool acquireLatestFrame() noexcept;
+    void adoptPendingClients();
+    void readRequests(Client& client);
+    void sendFrame(Client& client, const PublishedFrame& frame);
+
+    //==============================================================================
+    // Triple buffer: the publisher fills writeIndex, the sender reads readIndex,
+    // and the two swap through exchangeState (index plus a "new frame" bit)
+    static constexpr int newFrameBit = 4;
+    static constexpr int indexMask = 3;
+
+    std::array<PublishedFrame, 3> frames;
+    std::atomic<int> exchangeState { 1 };
+    int writeIndex = 0;
+    int readIndex = 2;
+
+    std::unique_ptr<Listener> listener;
+    juce::CriticalSection pendingLock;
+    std::vector<std::unique_ptr<Client>> pendingClients;  // Accepted, not yet served
+    std::vector<std::unique_ptr<Client>> clients;         // Sender thread only
+
+    std::vector<std::uint8_t> message;
+    std::vector<std::uint8_t> requestBody;
+    juce::uint32 sequence = 0;
+
+    std::atomic<bool> running { false };
+    int port = 0;
+    std::atomic<int> numClients { 0 };
+    std::atomic<juce::uint64> framesDropped { 0 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SpectrumStreamServer)
+};
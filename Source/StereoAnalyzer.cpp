@@ -0,0 +1,76 @@
+#include "StereoAnalyzer.h"
+#include <cmath>
+
+namespace
+{
+    // Below this product of channel powers a bin is treated as silent
+    constexpr float silentPowerProduct = 1.0e-24f;
+}
+
+//==============================================================================
+StereoAnalyzer::StereoAnalyzer()
+    : leftPower(static_cast<size_t>(SpectrumSnapshot::numBins)),
+      rightPower(static_cast<size_t>(SpectrumSnapshot::numBins)),
+      cross(static_cast<size_t>(SpectrumSnapshot::numBins))
+{
+    reset();
+}
+
+void StereoAnalyzer::reset() noexcept
+{
+    std::fill(leftPower.begin(), leftPower.end(), 0.0f);
+    std::fill(rightPower.begin(), rightPower.end(), 0.0f);
+    std::fill(cross.begin(), cross.end(), Complex());
+    hasHistory = false;
+}
+
+void StereoAnalyzer::setAveraging(float newAveraging) noexcept
+{
+    averaging = juce::jlimit(0.0f, 0.99f, newAveraging);
+}
+
+//==============================================================================
+void StereoAnalyzer::process(const Complex* left, const Complex* right,
+                             float* midMagnitudes, SpectrumSnapshot& snapshot) noexcept
+{
+    // The first frame seeds the averages instead of fading in from zero
+    const float keep = hasHistory ? averaging : 0.0f;
+    const float take = 1.0f - keep;
+    hasHistory = true;
+
+    for (int i = 0; i < SpectrumSnapshot::numBins; ++i)
+    {
+        const auto l = left[i];
+        const auto r = right[i];
+
+        midMagnitudes[i] = 0.5f * std::abs(l + r);
+
+        auto& lp = leftPower[static_cast<size_t>(i)];
+        auto& rp = rightPower[static_cast<size_t>(i)];
+        auto& lr = cross[static_cast<size_t>(i)];
+
+        lp = keep * lp + take * std::norm(l);
+        rp = keep * rp + take * std::norm(r);
+        lr = keep * lr + take * (l * std::conj(r));
+
+        const float powerProduct = lp * rp;
+
+        if (powerProduct > silentPowerProduct)
+        {
+            const float inverseRms = 1.0f / std::sqrt(powerProduct);
+            snapshot.coherence[i] = juce::jmin(1.0f, std::norm(lr) * inverseRms * inverseRms);
+            snapshot.correlation[i] = juce::jlimit(-1.0f, 1.0f, lr.real() * inverseRms);
+            snapshot.phase[i] = std::arg(lr);
+        }
+        else
+        {
+            snapshot.coherence[i] = 0.0f;
+            snapshot.correlation[i] = 0.0f;
+            snapshot.phase[i] = 0.0f;
+        }
+
+        // |S|^2 / (|M|^2 + |S|^2) with M, S = (L +- R) / 2, from the averaged spectra
+        const float total = lp + rp;
+        snapshot.width[i] = total > 0.0f ? juce::jlimit(0.0f, 1.0f, 0.5f - lr.real() / total) : 0.0f;
+    }
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <juce_dsp/juce_dsp.h>
+#include <vector>
+#include "SpectrumSnapshot.h"
+
+//==============================================================================
+// Stereo measurements from the left and right spectra of one frame. Auto and
+// cross spectra are averaged over time (coherence of a single frame is always
+// one), then turned into per-bin coherence, phase difference, correlation and
+// width. The mid magnitude for the main display falls out of the same spectra,
+// so no transform is spent on a mono mix.
+class StereoAnalyzer
+{
+public:
+    //==============================================================================
+    using Complex = juce::dsp::Complex<float>;
+
+    StereoAnalyzer();
+
+    void reset() noexcept;
+
+    // Weight of the previous average per frame, 0 (none) to just below 1
+    void setAveraging(float newAveraging) noexcept;
+    float getAveraging() const noexcept { return averaging; }
+
+    //==============================================================================
+    // left/right: SpectrumSnapshot::numBins bins each. Writes |L + R| / 2 into
+    // midMagnitudes and the stereo fields of the snapshot.
+    void process(const Complex* left, const Complex* right,
+                 float* midMagnitudes, SpectrumSnapshot& snapshot) noexcept;
+
+private:
+    //==============================================================================
+    std::vector<float> leftPower;   // <|L|^2>
+    std::vector<float> rightPower;  // <|R|^2>
+    std::vector<Complex> cross;     // <L R*>
+    float averaging = 0.8f;
+    bool hasHistory = false;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(StereoAnalyzer)
+};
@@ -0,0 +1,494 @@
+// Headless multi-instance soak test.
+//
+// Runs hundreds of SpectrumAnalyzerAudioProcessor instances on one simulated
+// audio thread, paced in real time, while the message thread cycles editors
+// open and closed, paints them offscreen, toggles bypass and changes the
+// session sample rate / block size the way a host does. At the end it reports
+// the worst processBlock against the real-time budget, memory growth and the
+// share of analysis frames lost to the ready-flag handoff.
+//
+// Usage: SpectrumAnalyzerSoakTest [--instances N] [--editors N] [--seconds S]
+//                                 [--seed N] [--fail-on-overrun]
+//
+// Every instance has its editor open by default, as in a session where each
+// plugin window is showing; --editors caps the number open at once. Editors
+// open at the start and are then closed and reopened at random.
+
+#include <juce_audio_processors/juce_audio_processors.h>
+#include <juce_gui_basics/juce_gui_basics.h>
+#include <atomic>
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <vector>
+#include "PluginProcessor.h"
+
+#if JUCE_LINUX
+ #include <unistd.h>
+#elif JUCE_MAC
+ #include <mach/mach.h>
+#endif
+
+namespace
+{
+    //==============================================================================
+    struct Options
+    {
+        int numInstances = 200;
+        int maxOpenEditors = -1;  // One per instance unless --editors is given
+        double seconds = 60.0;
+        int seed = 1;
+        bool failOnOverrun = false;
+    };
+
+    Options parseOptions(const juce::ArgumentList& args)
+    {
+        Options options;
+
+        if (args.containsOption("--instances"))
+            options.numInstances = juce::jmax(1, args.getValueForOption("--instances").getIntValue());
+
+        if (args.containsOption("--editors"))
+            options.maxOpenEditors = juce::jmax(0, args.getValueForOption("--editors").getIntValue());
+
+        if (args.containsOption("--seconds"))
+            options.seconds = juce::jmax(1.0, args.getValueForOption("--seconds").getDoubleValue());
+
+        if (args.containsOption("--seed"))
+            options.seed = args.getValueForOption("--seed").getIntValue();
+
+        if (options.maxOpenEditors < 0)
+            options.maxOpenEditors = options.numInstances;
+
+        options.failOnOverrun = args.containsOption("--fail-on-overrun");
+        return options;
+    }
+
+    // Resident set size in bytes, 0 where not supported
+    juce::int64 getResidentBytes()
+    {
+       #if JUCE_LINUX
+        const auto fields = juce::StringArray::fromTokens(juce::File("/proc/self/statm").loadFileAsString(), false);
+
+        if (fields.size() > 1)
+            return fields[1].getLargeIntValue() * static_cast<juce::int64>(sysconf(_SC_PAGESIZE));
+       #elif JUCE_MAC
+        mach_task_basic_info info;
+        mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+
+        if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO, reinterpret_cast<task_info_t>(&info), &count) == KERN_SUCCESS)
+            return static_cast<juce::int64>(info.resident_size);
+       #endif
+
+        return 0;
+    }
+
+    double ticksToMicroseconds(juce::int64 ticks)
+    {
+        return juce::Time::highResolutionTicksToSeconds(ticks) * 1.0e6;
+    }
+
+    //==============================================================================
+    // Host-side state of one plugin instance
+    struct Instance
+    {
+        std::unique_ptr<SpectrumAnalyzerAudioProcessor> processor;
+        std::unique_ptr<juce::AudioProcessorEditor> editor;
+        std::atomic<bool> bypassed { false };
+
+        // Handoff counters when the editor was opened; frames only count as
+        // lost while an editor is there to consume them
+        juce::uint32 capturedAtOpen = 0;
+        juce::uint32 droppedAtOpen = 0;
+    };
+
+    //==============================================================================
+    // Timing results; written by the audio thread, read after it has stopped
+    struct AudioStats
+    {
+        juce::int64 numCallbacks = 0;
+        juce::int64 numBlocks = 0;
+        juce::int64 numOverruns = 0;        // Callbacks whose processing exceeded the budget
+        juce::int64 numLateWakeups = 0;     // Callbacks that started behind schedule
+        double worstBlockMicroseconds = 0.0;
+        double worstBlockBudgetShare = 0.0; // Worst single processBlock / block duration
+        double worstCallbackBudgetShare = 0.0;
+        double totalBlockMicroseconds = 0.0;
+    };
+
+    //==============================================================================
+    class SoakTest : private juce::Thread,
+                     private juce::Timer
+    {
+    public:
+        explicit SoakTest(const Options& optionsToUse)
+            : juce::Thread("Soak audio"),
+              options(optionsToUse),
+              random(optionsToUse.seed)
+        {
+            instances.reserve(static_cast<size_t>(options.numInstances));
+
+            for (int i = 0; i < options.numInstances; ++i)
+            {
+                auto instance = std::make_unique<Instance>();
+                instance->processor = std::make_unique<SpectrumAnalyzerAudioProcessor>();
+                instances.push_back(std::move(instance));
+            }
+
+            reconfigureHost(48000.0, 512);
+        }
+
+        ~SoakTest() override
+        {
+            stopTimer();
+            stopThread(2000);
+
+            for (auto& instance : instances)
+                instance->editor.reset();
+        }
+
+        int runTest()
+        {
+            std::cout << "Soak test: " << options.numInstances << " instances, up to "
+                      << options.maxOpenEditors << " open editors, " << options.seconds << " s" << std::endl;
+
+            // Start at the full editor count so the whole run is under that load
+            for (int i = 0; i < juce::jmin(options.maxOpenEditors, options.numInstances); ++i)
+                cycleEditor(*instances[static_cast<size_t>(i)]);
+
+            startTime = juce::Time::getMillisecondCounterHiRes();
+            startThread(juce::Thread::Priority::highest);
+            startTimerHz(messageTickHz);
+
+            juce::MessageManager::getInstance()->runDispatchLoop();
+
+            stopTimer();
+            stopThread(2000);
+
+            for (auto& instance : instances)
+                closeEditor(*instance);
+
+            return report();
+        }
+
+    private:
+        //==============================================================================
+        static constexpr int messageTickHz = 30;
+        static constexpr int paintsPerTick = 8;
+        static constexpr int numChannels = 2;
+
+        // Audio thread: one simulated device callback processes every instance
+        void run() override
+        {
+            juce::AudioBuffer<float> source(numChannels, maxBlockSizeLimit);
+            juce::AudioBuffer<float> work(numChannels, maxBlockSizeLimit);
+            juce::MidiBuffer midi;
+            juce::Random audioRandom(options.seed + 1);
+
+            auto nextCallback = juce::Time::getHighResolutionTicks();
+
+            while (!threadShouldExit())
+            {
+                int numSamples = 0;
+                double sampleRate = 0.0;
+
+                {
+                    // Held for the whole callback, like a device callback; the
+                    // message thread takes it to reconfigure
+                    const juce::ScopedLock sl(hostLock);
+
+                    sampleRate = hostSampleRate;
+
+                    // Mostly full blocks, sometimes split ones as hosts do around automation
+                    numSamples = audioRandom.nextInt(4) == 0 ? 1 + audioRandom.nextInt(hostBlockSize)
+                                                             : hostBlockSize;
+
+                    generateInput(source, numSamples, sampleRate, audioRandom);
+                    processCallback(source, work, midi, numSamples, sampleRate);
+                }
+
+                // Pace the callbacks in real time so the GUI consumes frames at a realistic rate
+                nextCallback += juce::Time::secondsToHighResolutionTicks(numSamples / sampleRate);
+                const auto now = juce::Time::getHighResolutionTicks();
+
+                if (nextCallback > now)
+                {
+                    wait(juce::jmax(0, static_cast<int>(juce::Time::highResolutionTicksToSeconds(nextCallback - now) * 1000.0)));
+                }
+                else
+                {
+                    ++audioStats.numLateWakeups;
+                    nextCallback = now;
+                }
+            }
+        }
+
+        void processCallback(const juce::AudioBuffer<float>& source, juce::AudioBuffer<float>& work,
+                             juce::MidiBuffer& midi, int numSamples, double sampleRate)
+        {
+            const double budgetMicroseconds = numSamples / sampleRate * 1.0e6;
+            double callbackMicroseconds = 0.0;
+
+            for (auto& instance : instances)
+            {
+                // Each instance gets the same input; a view avoids reallocating per block size
+                for (int channel = 0; channel < numChannels; ++channel)
+                    work.copyFrom(channel, 0, source, channel, 0, numSamples);
+
+                juce::AudioBuffer<float> block(work.getArrayOfWritePointers(), numChannels, numSamples);
+
+                const auto start = juce::Time::getHighResolutionTicks();
+
+                if (instance->bypassed.load(std::memory_order_relaxed))
+                    instance->processor->processBlockBypassed(block, midi);
+                else
+                    instance->processor->processBlock(block, midi);
+
+                const double elapsed = ticksToMicroseconds(juce::Time::getHighResolutionTicks() - start);
+
+                callbackMicroseconds += elapsed;
+                audioStats.totalBlockMicroseconds += elapsed;
+                audioStats.worstBlockMicroseconds = juce::jmax(audioStats.worstBlockMicroseconds, elapsed);
+                audioStats.worstBlockBudgetShare = juce::jmax(audioStats.worstBlockBudgetShare, elapsed / budgetMicroseconds);
+                ++audioStats.numBlocks;
+            }
+
+            const double callbackShare = callbackMicroseconds / budgetMicroseconds;
+            audioStats.worstCallbackBudgetShare = juce::jmax(audioStats.worstCallbackBudgetShare, callbackShare);
+
+            if (callbackShare > 1.0)
+                ++audioStats.numOverruns;
+
+            ++audioStats.numCallbacks;
+        }
+
+        // Logarithmic sine sweep plus a little noise, decorrelated between channels
+        void generateInput(juce::AudioBuffer<float>& buffer, int numSamples, double sampleRate, juce::Random& audioRandom)
+        {
+            constexpr double sweepSeconds = 10.0;
+            const double ratio = std::log(15000.0 / 50.0);
+
+            for (int i = 0; i < numSamples; ++i)
+            {
+                const double position = std::fmod(sweepTime, sweepSeconds) / sweepSeconds;
+                const double frequency = 50.0 * std::exp(ratio * position);
+
+                sweepPhase += juce::MathConstants<double>::twoPi * frequency / sampleRate;
+
+                if (sweepPhase > juce::MathConstants<double>::twoPi)
+                    sweepPhase -= juce::MathConstants<double>::twoPi;
+
+                sweepTime += 1.0 / sampleRate;
+
+                const auto tone = static_cast<float>(0.5 * std::sin(sweepPhase));
+
+                for (int channel = 0; channel < numChannels; ++channel)
+                    buffer.setSample(channel, i, tone + 0.01f * (audioRandom.nextFloat() - 0.5f));
+            }
+        }
+
+        //==============================================================================
+        // Message thread: host events and offscreen painting
+        void timerCallback() override
+        {
+            const double elapsedSeconds = (juce::Time::getMillisecondCounterHiRes() - startTime) / 1000.0;
+
+            if (elapsedSeconds >= options.seconds)
+            {
+                stopTimer();
+                juce::MessageManager::getInstance()->stopDispatchLoop();
+                return;
+            }
+
+            // Baseline after warm-up, once caches and editor resources exist
+            if (baselineResidentBytes == 0 && elapsedSeconds >= juce::jmin(5.0, options.seconds * 0.25))
+                baselineResidentBytes = getResidentBytes();
+
+            paintOpenEditors();
+
+            // A few host events per second
+            if (random.nextInt(messageTickHz / 4) == 0)
+                toggleBypass(*instances[static_cast<size_t>(random.nextInt(options.numInstances))]);
+
+            if (random.nextInt(messageTickHz / 8) == 0)
+                cycleEditor(*instances[static_cast<size_t>(random.nextInt(options.numInstances))]);
+
+            // Session reconfiguration every ten seconds or so
+            if (random.nextInt(messageTickHz * 10) == 0)
+            {
+                static constexpr double sampleRates[] = { 44100.0, 48000.0, 88200.0, 96000.0, 192000.0 };
+                static constexpr int blockSizes[] = { 64, 128, 256, 480, 512, 1024, 2048 };
+
+                reconfigureHost(sampleRates[random.nextInt(juce::numElementsInArray(sampleRates))],
+                                blockSizes[random.nextInt(juce::numElementsInArray(blockSizes))]);
+            }
+        }
+
+        void paintOpenEditors()
+        {
+            if (openEditors.isEmpty())
+                return;
+
+            for (int i = 0; i < juce::jmin(paintsPerTick, openEditors.size()); ++i)
+            {
+                paintCursor = (paintCursor + 1) % openEditors.size();
+                auto* editor = instances[static_cast<size_t>(openEditors[paintCursor])]->editor.get();
+
+                // Renders the whole editor into an image, as a repaint would
+                juce::ignoreUnused(editor->createComponentSnapshot(editor->getLocalBounds()));
+                ++numPaints;
+            }
+        }
+
+        void toggleBypass(Instance& instance)
+        {
+            instance.bypassed.store(!instance.bypassed.load());
+            ++numBypassToggles;
+        }
+
+        void cycleEditor(Instance& instance)
+        {
+            if (instance.editor != nullptr)
+            {
+                closeEditor(instance);
+                return;
+            }
+
+            // Keep within the limit by closing the longest-open editor first
+            if (openEditors.size() >= options.maxOpenEditors)
+            {
+                if (openEditors.isEmpty())
+                    return;
+
+                closeEditor(*instances[static_cast<size_t>(openEditors[0])]);
+            }
+
+            instance.editor.reset(instance.processor->createEditorIfNeeded());
+            instance.capturedAtOpen = instance.processor->getNumFramesCaptured();
+            instance.droppedAtOpen = instance.processor->getNumFramesDropped();
+            openEditors.add(indexOf(instance));
+            ++numEditorOpens;
+        }
+
+        void closeEditor(Instance& instance)
+        {
+            if (instance.editor == nullptr)
+                return;
+
+            framesCaptured += instance.processor->getNumFramesCaptured() - instance.capturedAtOpen;
+            framesDropped += instance.processor->getNumFramesDropped() - instance.droppedAtOpen;
+
+            instance.editor.reset();
+            openEditors.removeFirstMatchingValue(indexOf(instance));
+        }
+
+        int indexOf(const Instance& instance) const
+        {
+            for (size_t i = 0; i < instances.size(); ++i)
+                if (instances[i].get() == &instance)
+                    return static_cast<int>(i);
+
+            jassertfalse;
+            return -1;
+        }
+
+        // Like a device restart: audio is held off while every instance is re-prepared
+        void reconfigureHost(double sampleRate, int blockSize)
+        {
+            const juce::ScopedLock sl(hostLock);
+
+            for (auto& instance : instances)
+            {
+                instance->processor->setRateAndBufferSizeDetails(sampleRate, blockSize);
+                instance->processor->prepareToPlay(sampleRate, blockSize);
+            }
+
+            hostSampleRate = sampleRate;
+            hostBlockSize = blockSize;
+            ++numReconfigurations;
+        }
+
+        //==============================================================================
+        int report() const
+        {
+            const auto endResidentBytes = getResidentBytes();
+            const auto& s = audioStats;
+            const auto totalFrames = framesCaptured + framesDropped;
+
+            std::cout << juce::String::formatted(
+                "\nAudio: %lld callbacks, %lld processBlock calls, %lld late wake-ups\n"
+                "  worst processBlock:  %.1f us (%.2f%% of its block's budget)\n"
+                "  mean processBlock:   %.2f us\n"
+                "  worst callback:      %.2f%% of budget for all instances, %lld overruns\n",
+                s.numCallbacks, s.numBlocks, s.numLateWakeups,
+                s.worstBlockMicroseconds, s.worstBlockBudgetShare * 100.0,
+                s.numBlocks > 0 ? s.totalBlockMicroseconds / static_cast<double>(s.numBlocks) : 0.0,
+                s.worstCallbackBudgetShare * 100.0, s.numOverruns) << std::flush;
+
+            std::cout << juce::String::formatted(
+                "Host: %d reconfigurations, %d bypass toggles, %d editor opens, %d offscreen paints\n",
+                numReconfigurations, numBypassToggles, numEditorOpens, numPaints) << std::flush;
+
+            std::cout << juce::String::formatted(
+                "Handoff: %llu frames captured, %llu lost while an editor was open (%.2f%%)\n",
+                static_cast<unsigned long long>(framesCaptured), static_cast<unsigned long long>(framesDropped),
+                totalFrames > 0 ? 100.0 * static_cast<double>(framesDropped) / static_cast<double>(totalFrames) : 0.0)
+                      << std::flush;
+
+            if (baselineResidentBytes > 0 && endResidentBytes > 0)
+            {
+                std::cout << juce::String::formatted(
+                    "Memory: %.1f MB after warm-up, %.1f MB at end, growth %+.1f MB\n",
+                    baselineResidentBytes / 1048576.0, endResidentBytes / 1048576.0,
+                    (endResidentBytes - baselineResidentBytes) / 1048576.0) << std::flush;
+            }
+            else
+            {
+                std::cout << "Memory: resident size not available on this platform" << std::endl;
+            }
+
+            return options.failOnOverrun && s.numOverruns > 0 ? 1 : 0;
+        }
+
+        //==============================================================================
+        static constexpr int maxBlockSizeLimit = 2048;
+
+        const Options options;
+        juce::Random random;
+        std::vector<std::unique_ptr<Instance>> instances;
+        juce::Array<int> openEditors;  // Instance indices, oldest first
+        int paintCursor = 0;
+
+        // Session settings, guarded by hostLock
+        juce::CriticalSection hostLock;
+        double hostSampleRate = 48000.0;
+        int hostBlockSize = 512;
+
+        // Audio thread only
+        AudioStats audioStats;
+        double sweepPhase = 0.0;
+        double sweepTime = 0.0;
+
+        // Message thread only
+        double startTime = 0.0;
+        juce::int64 baselineResidentBytes = 0;
+        juce::uint64 framesCaptured = 0;
+        juce::uint64 framesDropped = 0;
+        int numReconfigurations = 0;
+        int numBypassToggles = 0;
+        int numEditorOpens = 0;
+        int numPaints = 0;
+
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SoakTest)
+    };
+}
+
+//==============================================================================
+int main(int argc, char* argv[])
+{
+    const juce::ScopedJuceInitialiser_GUI juceInitialiser;
+    const juce::ArgumentList args(argc, argv);
+
+    SoakTest test(parseOptions(args));
+    return test.runTest();
+}
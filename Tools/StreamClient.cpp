@@ -0,0 +1,239 @@
+// Minimal remote display for the spectrum stream.
+//
+// Connects to a SpectrumStreamServer, asks for as many columns as the window
+// is wide and draws the received frames with SpectrumAnalyzerComponent. The
+// server listens on loopback only; reach another machine through a tunnel,
+// e.g. ssh -L 50321:127.0.0.1:50321 rack-machine.
+//
+// Usage: SpectrumAnalyzerStreamClient [--host 127.0.0.1] [--port 50321]
+
+#include <juce_gui_basics/juce_gui_basics.h>
+#include <atomic>
+#include <functional>
+#include <vector>
+#include "SpectrumAnalyzerComponent.h"
+#include "SpectrumDisplaySource.h"
+#include "SpectrumStreamProtocol.h"
+
+namespace
+{
+    //==============================================================================
+    // Network thread: keeps a connection open, decodes frames and reports them
+    class StreamConnection : public juce::Thread
+    {
+    public:
+        StreamConnection(const juce::String& hostToUse, int portToUse)
+            : juce::Thread("Spectrum stream client"),
+              host(hostToUse),
+              port(portToUse)
+        {
+        }
+
+        ~StreamConnection() override
+        {
+            stopThread(2000);
+        }
+
+        void setRequestedColumns(int numColumns) noexcept
+        {
+            requestedColumns.store(juce::jlimit(1, SpectrumStreamProtocol::maxColumns, numColumns));
+        }
+
+        // Called on this thread with the decoded columns in dB
+        std::function<void(const std::vector<float>&, int numValidColumns, double sampleRate)> onFrame;
+
+    private:
+        void run() override
+        {
+            while (!threadShouldExit())
+            {
+                juce::StreamingSocket socket;
+
+                if (socket.connect(host, port, 1000))
+                    serve(socket);
+
+                // Retry until the server (re)appears
+                wait(1000);
+            }
+        }
+
+        void serve(juce::StreamingSocket& socket)
+        {
+            std::vector<std::uint8_t> message, body, quantized;
+            std::vector<float> columns;
+            int sentRequest = 0;
+
+            while (!threadShouldExit())
+            {
+                const int wanted = requestedColumns.load();
+
+                if (wanted != sentRequest)
+                {
+                    message.clear();
+                    SpectrumStreamProtocol::encodeColumnRequest(wanted, message);
+
+                    if (socket.write(message.data(), static_cast<int>(message.size())) != static_cast<int>(message.size()))
+                        return;
+
+                    sentRequest = wanted;
+                }
+
+                // Nothing within the timeout is fine; go round to check for a new width
+                if (socket.waitUntilReady(true, 100) != 1)
+                    continue;
+
+                SpectrumStreamProtocol::FrameInfo info;
+
+                if (!SpectrumStreamProtocol::readMessage(socket, body, 1000)
+                    || !SpectrumStreamProtocol::decodeFrame(body.data(), static_cast<int>(body.size()), info, quantized))
+                    return;
+
+                columns.resize(quantized.size());
+
+                for (size_t c = 0; c < quantized.size(); ++c)
+                    columns[c] = SpectrumStreamProtocol::dequantize(quantized[c]);
+
+                if (onFrame != nullptr)
+                    onFrame(columns, info.numValidColumns, info.sampleRate);
+            }
+        }
+
+        const juce::String host;
+        const int port;
+        std::atomic<int> requestedColumns { 640 };
+    };
+
+    //==============================================================================
+    // Display source with no local analysis: the component draws only the
+    // columns it is handed, so there is no engine or processor to run
+    class RemoteDisplaySource : public SpectrumDisplaySource
+    {
+    public:
+        SpectrumAnalysisEngine* getDisplayedEngine() noexcept override { return nullptr; }
+
+        void addDisplayListener(Listener*) override {}
+        void removeDisplayListener(Listener*) override {}
+
+        void setPeakMarkersEnabled(bool) override {}
+        bool arePeakMarkersEnabled() const override { return false; }
+        void setHistoryDisplay(int) override {}
+        int getHistoryDisplay() const override { return 0; }
+        void setLowLatencyMode(bool) override {}
+        bool isLowLatencyMode() const override { return false; }
+    };
+
+    //==============================================================================
+    class ClientContent : public juce::Component,
+                          private juce::AsyncUpdater
+    {
+    public:
+        ClientContent(const juce::String& host, int port)
+            : spectrumComponent(displaySource),
+              connection(host, port)
+        {
+            addAndMakeVisible(spectrumComponent);
+
+            connection.onFrame = [this](const std::vector<float>& columns, int numValidColumns, double sampleRate)
+            {
+                {
+                    const juce::ScopedLock sl(frameLock);
+                    latestColumns = columns;
+                    latestValidColumns = numValidColumns;
+                    latestSampleRate = sampleRate;
+                }
+
+                triggerAsyncUpdate();
+            };
+
+            setSize(760, 300);
+            connection.startThread();
+        }
+
+        ~ClientContent() override
+        {
+            connection.stopThread(2000);
+            cancelPendingUpdate();
+        }
+
+        void resized() override
+        {
+            spectrumComponent.setBounds(getLocalBounds());
+            connection.setRequestedColumns(getWidth());
+        }
+
+    private:
+        void handleAsyncUpdate() override
+        {
+            const juce::ScopedLock sl(frameLock);
+
+            if (!latestColumns.empty())
+                spectrumComponent.setRemoteColumns(latestColumns.data(), static_cast<int>(latestColumns.size()),
+                                                   latestValidColumns, latestSampleRate);
+        }
+
+        RemoteDisplaySource displaySource;
+        SpectrumAnalyzerComponent spectrumComponent;
+        StreamConnection connection;
+
+        juce::CriticalSection frameLock;
+        std::vector<float> latestColumns;
+        int latestValidColumns = 0;
+        double latestSampleRate = 0.0;
+    };
+
+    //==============================================================================
+    class ClientWindow : public juce::DocumentWindow
+    {
+    public:
+        ClientWindow(const juce::String& host, int port)
+            : juce::DocumentWindow("Spectrum Stream - " + host + ":" + juce::String(port),
+                                   juce::Colour(0xFF0D0D1A), juce::DocumentWindow::allButtons)
+        {
+            setUsingNativeTitleBar(true);
+            setContentOwned(new ClientContent(host, port), true);
+            setResizable(true, true);
+            centreWithSize(getWidth(), getHeight());
+            setVisible(true);
+        }
+
+        void closeButtonPressed() override
+        {
+            juce::JUCEApplication::getInstance()->systemRequestedQuit();
+        }
+    };
+}
+
+//==============================================================================
+class StreamClientApplication : public juce::JUCEApplication
+{
+public:
+    const juce::String getApplicationName() override { return "Spectrum Analyzer Stream Client"; }
+    const juce::String getApplicationVersion() override { return "1.0.0"; }
+
+    void initialise(const juce::String& commandLine) override
+    {
+        const auto args = juce::StringArray::fromTokens(commandLine, true);
+        juce::String host = "127.0.0.1";
+        int port = SpectrumStreamProtocol::defaultPort;
+
+        for (int i = 0; i + 1 < args.size(); ++i)
+        {
+            if (args[i] == "--host")
+                host = args[i + 1].unquoted();
+            else if (args[i] == "--port")
+                port = args[i + 1].getIntValue();
+        }
+
+        window = std::make_unique<ClientWindow>(host, port);
+    }
+
+    void shutdown() override
+    {
+        window.reset();
+    }
+
+private:
+    std::unique_ptr<ClientWindow> window;
+};
+
+START_JUCE_APPLICATION(StreamClientApplication)